@@ -3,7 +3,11 @@
 #include <string>
 #include <vector>
 #include <sstream>
+#include <cstdio>
+#include <cstring>
 #include "UTime.h"
+#include "ChunkFile.h"
+#include "ChunkWriter.h"
 
 #define BUILD_WITH_EASY_PROFILER
 #include <easy/profiler.h>
@@ -33,21 +37,48 @@ Chunk::~Chunk() {
     //if(biomes) delete biomes;
 }
 
+// the chunk's saved data, from its region or else its own file
+// returns false if it has none
+static bool readChunkData(Chunk* ch, const char* fname, bool* ownFile, RegionView& data) {
+    *ownFile = false;
+    if(ch->region && ch->region->view(RegionFile::local(ch->x), RegionFile::local(ch->y), data)) return true;
+    if(!ch->hasOwnFile) return false;
+
+    ifstream myfile(fname, std::ios::binary | std::ios::ate);
+    if(!myfile.is_open()) return false;
+    data.buffer.resize((size_t)myfile.tellg());
+    myfile.seekg(0);
+    myfile.read(data.buffer.data(), data.buffer.size());
+    myfile.close();
+    data.data = data.buffer.data();
+    data.size = data.buffer.size();
+    *ownFile = true;
+    return true;
+}
+
 void Chunk::loadMeta() {
-    string line;
-    ifstream myfile(fname);
-    if(myfile.is_open()) {
-        getline(myfile, line, '\n');
+    // a save still waiting is newer than the files
+    if(writer) {
+        std::shared_ptr<const ChunkSnapshot> pending = writer->find(x, y);
+        if(pending) {
+            generationPhase = pending->generationPhase;
+            hasMeta = true;
+            return;
+        }
+    }
 
-        int phase = stoi(line);
-        generationPhase = phase;
-        hasMeta = true;
+    RegionView data;
+    bool ownFile;
+    if(readChunkData(this, fname, &ownFile, data)) {
+        int phase;
+        if(ChunkFile::decodePhase(data.data, data.size, &phase)) {
+            generationPhase = phase;
+            hasMeta = true;
+        }
     }
 }
 
-MaterialInstanceData* Chunk::readBuf = (MaterialInstanceData*)malloc(CHUNK_W * CHUNK_H * 2 * sizeof(MaterialInstanceData));
-
-void Chunk::read() {
+bool Chunk::read(std::vector<char>& scratch) {
     EASY_FUNCTION();
 
     EASY_BLOCK("create arrays");
@@ -61,78 +92,52 @@ void Chunk::read() {
     Uint32* background = new Uint32[CHUNK_W * CHUNK_H];
     EASY_END_BLOCK;
 
-    EASY_BLOCK("open file");
-    string line;
-    ifstream myfile(fname, std::ios::binary);
-    EASY_END_BLOCK;
-    if(myfile.is_open()) {
-        int state = 0;
-
-        getline(myfile, line, '\n');
-        int phase = stoi(line);
-        this->generationPhase = phase;
-
+    // a save still waiting is newer than the files
+    std::shared_ptr<const ChunkSnapshot> pending = writer ? writer->find(x, y) : nullptr;
+    if(pending) {
+        EASY_BLOCK("copy pending save");
+        memcpy(tiles, pending->tiles.data(), CHUNK_W * CHUNK_H * sizeof(MaterialInstance));
+        memcpy(layer2, pending->layer2.data(), CHUNK_W * CHUNK_H * sizeof(MaterialInstance));
+        memcpy(background, pending->background.data(), CHUNK_W * CHUNK_H * sizeof(Uint32));
+        this->generationPhase = pending->generationPhase;
         hasMeta = true;
-        state = 1;
-
-        /*unsigned int content;
-        for (int i = 0; i < CHUNK_W * CHUNK_H; i++) {
-            myfile.read((char*)&content, sizeof(unsigned int));
-            int id = content;
-            myfile.read((char*)&content, sizeof(unsigned int));
-            Uint32 color = content;
-            tiles[i] = MaterialInstance(Materials::MATERIALS[id], color);
-        }
-        for (int i = 0; i < CHUNK_W * CHUNK_H; i++) {
-            myfile.read((char*)&content, sizeof(unsigned int));
-            int id = content;
-            myfile.read((char*)&content, sizeof(unsigned int));
-            Uint32 color = content;
-            layer2[i] = MaterialInstance(Materials::MATERIALS[id], color);
-        }*/
-        /*for (int i = 0; i < CHUNK_W * CHUNK_H; i++) {
-            myfile.read((char*)&content, sizeof(unsigned int));
-            background[i] = content;
-        }*/
-
-        EASY_BLOCK("read MaterialInstanceData");
-        myfile.read((char*)readBuf, CHUNK_W * CHUNK_H * 2 * sizeof(MaterialInstanceData));
+        // the waiting save takes care of the old file
+        readOwnFile = false;
         EASY_END_BLOCK;
 
-        EASY_BLOCK("copy MaterialInstanceData");
-        // copy everything but the material pointer
-        memcpy(tiles, readBuf, CHUNK_W * CHUNK_H * sizeof(MaterialInstance));
-        memcpy(layer2, &readBuf[CHUNK_W * CHUNK_H], CHUNK_W * CHUNK_H * sizeof(MaterialInstance));
-
-        // copy the material pointer
-        for(int i = 0; i < CHUNK_W * CHUNK_H; i++) {
-            // twice as fast to set fields instead of making new ones
-
-            tiles[i].mat = Materials::MATERIALS_ARRAY[readBuf[i].index];
-            //tiles[i].color = readBuf[i].color;
-            //tiles[i].temperature = readBuf[i].temperature;
-            //tiles[i] = MaterialInstance(Materials::MATERIALS_ARRAY[buf[i].index], buf[i].color, buf[i].temperature);
-
-            layer2[i].mat = Materials::MATERIALS_ARRAY[readBuf[CHUNK_W * CHUNK_H + i].index];
-            //layer2[i].color = readBuf[CHUNK_W * CHUNK_H + i].color;
-            //layer2[i].temperature = readBuf[CHUNK_W * CHUNK_H + i].temperature;
-            //layer2[i] = MaterialInstance(Materials::MATERIALS_ARRAY[buf[CHUNK_W * CHUNK_H + i].index], buf[CHUNK_W * CHUNK_H + i].color, buf[CHUNK_W * CHUNK_H + i].temperature);
-        }
-        EASY_END_BLOCK;
-
-        //delete readBuf;
+        this->tiles = tiles;
+        this->layer2 = layer2;
+        this->background = background;
+        hasTileCache = true;
+        return true;
+    }
 
-        EASY_BLOCK("read background data");
-        myfile.read((char*)background, CHUNK_W * CHUNK_H * sizeof(unsigned int));
-        EASY_END_BLOCK;
+    EASY_BLOCK("read file");
+    // decoded straight out of the mapped region file
+    RegionView data;
+    bool found = readChunkData(this, fname, &readOwnFile, data);
+    EASY_END_BLOCK;
 
-        myfile.close();
+    EASY_BLOCK("decode");
+    int phase;
+    bool decoded = found && ChunkFile::decode(data.data, data.size, &phase, tiles, layer2, background, scratch);
+    EASY_END_BLOCK;
+    if(!decoded) {
+        // a torn write leaves a damaged chunk behind, generating it again overwrites it
+        if(found) logWarn("Chunk {} {} is damaged, generating it again", x, y);
+        free(tiles);
+        free(layer2);
+        delete[] background;
+        return false;
     }
+    this->generationPhase = phase;
+    hasMeta = true;
 
     this->tiles = tiles;
     this->layer2 = layer2;
     this->background = background;
     hasTileCache = true;
+    return true;
 }
 
 void Chunk::write(MaterialInstance* tiles, MaterialInstance* layer2, Uint32* background) {
@@ -143,39 +148,34 @@ void Chunk::write(MaterialInstance* tiles, MaterialInstance* layer2, Uint32* bac
     this->background = background;
     hasTileCache = true;
 
-    ofstream myfile;
-    myfile.open(fname, std::ios::binary);
-    myfile << generationPhase << "\n";
+    EASY_BLOCK("snapshot");
+    std::shared_ptr<ChunkSnapshot> snapshot = std::make_shared<ChunkSnapshot>();
+    snapshot->x = x;
+    snapshot->y = y;
+    snapshot->generationPhase = generationPhase;
+    snapshot->region = region;
+    snapshot->fname = fname;
+    snapshot->removeOwnFile = readOwnFile;
+    snapshot->tiles.assign(tiles, tiles + CHUNK_W * CHUNK_H);
+    snapshot->layer2.assign(layer2, layer2 + CHUNK_W * CHUNK_H);
+    snapshot->background.assign(background, background + CHUNK_W * CHUNK_H);
+    EASY_END_BLOCK;
+    // the region will have it, the save removes the old file
+    if(region) readOwnFile = false;
 
-    // TODO: make these loops faster
-    /*for (int i = 0; i < CHUNK_W * CHUNK_H; i++) {
-        myfile.write((char*)&tiles[i].mat.id, sizeof(unsigned int));
-        myfile.write((char*)&tiles[i].color, sizeof(unsigned int));
-    }
-    for (int i = 0; i < CHUNK_W * CHUNK_H; i++) {
-        myfile.write((char*)&layer2[i].mat.id, sizeof(unsigned int));
-        myfile.write((char*)&layer2[i].color, sizeof(unsigned int));
-    }*/
-    /*for (int i = 0; i < CHUNK_W * CHUNK_H; i++) {
-        myfile.write((char*)&background[i], sizeof(unsigned int));
-    }*/
-
-
-    MaterialInstanceData* buf = new MaterialInstanceData[CHUNK_W * CHUNK_H * 2];
-    for(int i = 0; i < CHUNK_W * CHUNK_H; i++) {
-        buf[i] ={(Uint32)tiles[i].mat->id, tiles[i].color, tiles[i].temperature};
-        buf[CHUNK_W * CHUNK_H + i] ={(Uint32)layer2[i].mat->id, layer2[i].color, layer2[i].temperature};
+    if(writer) {
+        writer->queue(snapshot);
+    } else {
+        ChunkWriter::save(*snapshot);
     }
-
-    myfile.write((char*)buf, CHUNK_W * CHUNK_H * 2 * sizeof(MaterialInstanceData));
-    delete[] buf;
-    myfile.write((char*)background, CHUNK_W * CHUNK_H * sizeof(unsigned int));
-
-    myfile.close();
 }
 
 bool Chunk::hasFile() {
     EASY_FUNCTION();
+    if(writer && writer->find(x, y)) return true;
+    if(region && region->has(RegionFile::local(x), RegionFile::local(y))) return true;
+    // only chunks that had a file of their own when the world was opened need to look for it
+    if(!hasOwnFile) return false;
     struct stat buffer;
     return (stat(fname, &buffer) == 0);
 }
@@ -23,15 +23,31 @@
 #endif // !INC_Biome
 
 #include "RigidBody.h"
+#include "RegionFile.h"
 
+class ChunkWriter;
+
+// a cell as stored in chunk files
+// this has the same layout as MaterialInstance so tiles can be read and written without converting them
+typedef struct {
+    uint16_t index;
+    int16_t temperature;
+    Uint32 color;
+} MaterialInstanceData;
+
+static_assert(sizeof(MaterialInstanceData) == sizeof(MaterialInstance), "MaterialInstanceData must match the layout of MaterialInstance");
+
+// a cell as stored in chunk files written before MaterialInstance was packed, see ChunkFile::decode
 typedef struct {
     Uint32 index;
     Uint32 color;
     int32_t temperature;
-} MaterialInstanceData;
+} MaterialInstanceDataV0;
 
 class Chunk {
+    // the file of the old one file per chunk layout, only read until the chunk is written to its region
     const char* fname;
+    bool readOwnFile = false;
 public:
     int x;
     int y;
@@ -39,6 +55,12 @@ public:
     // in order for a chunk to execute phase generationPhase+1, all surrounding chunks must be at least generationPhase
     int generationPhase = 0;
     bool pleaseDelete = false;
+    // the region file the chunk is saved in, see World::getRegion
+    RegionFile* region = nullptr;
+    // whether fname existed when the world was opened, see World::ownFileChunks
+    bool hasOwnFile = false;
+    // saves the chunk in the background, see World::chunkWriter
+    ChunkWriter* writer = nullptr;
 
     Chunk(int x, int y, char* worldName);
     Chunk() : Chunk(0, 0, (char*)"chunks") {};
@@ -46,8 +68,9 @@ public:
 
     void loadMeta();
 
-    static MaterialInstanceData* readBuf;
-    void read();
+    // scratch is for inflating the file, see ChunkFile::decode
+    // returns false if nothing is saved or the saved chunk is damaged, the chunk is left without tiles and has to be generated
+    bool read(std::vector<char>& scratch);
     void write(MaterialInstance* tiles, MaterialInstance* layer2, Uint32* background);
     bool hasFile();
 
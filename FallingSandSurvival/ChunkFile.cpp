@@ -0,0 +1,244 @@
+
+#include "ChunkFile.h"
+#include "Chunk.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <zlib.h>
+
+#define CHUNK_CELLS (CHUNK_W * CHUNK_H)
+// most cells a run can hold
+#define RUN_MAX 0x8000
+#define RUN_REPEAT 0x8000
+// the largest body encode can write: a palette entry for every cell and a count in front of every value
+// each layer has the palette size, the palette, then indices, temperatures and colors
+#define LAYER_MAX (2 + CHUNK_CELLS * (2 + (2 + 2) + (2 + 2) + (2 + 4)))
+#define BODY_MAX (LAYER_MAX * 2 + CHUNK_CELLS * (2 + 4))
+
+template<typename T> static void put(std::vector<char>& out, T v) {
+    size_t at = out.size();
+    out.resize(at + sizeof(T));
+    memcpy(&out[at], &v, sizeof(T));
+}
+
+template<typename T> static bool get(const char*& p, const char* end, T* v) {
+    if(end - p < (ptrdiff_t)sizeof(T)) return false;
+    memcpy(v, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+}
+
+template<typename T> static void writeRuns(const std::vector<T>& v, std::vector<char>& out) {
+    int n = (int)v.size();
+    int i = 0;
+    while(i < n) {
+        int run = 1;
+        while(i + run < n && run < RUN_MAX && v[i + run] == v[i]) run++;
+
+        if(run > 1) {
+            put<uint16_t>(out, (uint16_t)(RUN_REPEAT | (run - 1)));
+            put<T>(out, v[i]);
+            i += run;
+        } else {
+            // literals until the next pair of equal values
+            int lit = 1;
+            while(i + lit < n && lit < RUN_MAX && !(i + lit + 1 < n && v[i + lit] == v[i + lit + 1])) lit++;
+            put<uint16_t>(out, (uint16_t)(lit - 1));
+            size_t at = out.size();
+            out.resize(at + lit * sizeof(T));
+            memcpy(&out[at], &v[i], lit * sizeof(T));
+            i += lit;
+        }
+    }
+}
+
+// calls set(i, value) for each of the n values
+template<typename T, typename F> static bool readRuns(const char*& p, const char* end, int n, F set) {
+    int i = 0;
+    while(i < n) {
+        uint16_t ctl;
+        if(!get(p, end, &ctl)) return false;
+        int count = (ctl & (RUN_REPEAT - 1)) + 1;
+        if(i + count > n) return false;
+
+        T v;
+        if(ctl & RUN_REPEAT) {
+            if(!get(p, end, &v)) return false;
+            for(int j = 0; j < count; j++) set(i++, v);
+        } else {
+            for(int j = 0; j < count; j++) {
+                if(!get(p, end, &v)) return false;
+                set(i++, v);
+            }
+        }
+    }
+    return true;
+}
+
+static void writeLayer(const MaterialInstance* layer, std::vector<char>& out) {
+    std::vector<uint16_t> palette;
+    std::vector<int> paletteIndex(Materials::nMaterials, -1);
+    std::vector<uint16_t> indices(CHUNK_CELLS);
+    std::vector<int16_t> temperatures(CHUNK_CELLS);
+    std::vector<Uint32> colors(CHUNK_CELLS);
+    for(int i = 0; i < CHUNK_CELLS; i++) {
+        uint16_t id = layer[i].mat.id;
+        if(paletteIndex[id] < 0) {
+            paletteIndex[id] = (int)palette.size();
+            palette.push_back(id);
+        }
+        indices[i] = (uint16_t)paletteIndex[id];
+        temperatures[i] = layer[i].temperature;
+        colors[i] = layer[i].color;
+    }
+
+    put<uint16_t>(out, (uint16_t)palette.size());
+    for(uint16_t id : palette) put<uint16_t>(out, id);
+    if(palette.size() <= 256) {
+        writeRuns(std::vector<uint8_t>(indices.begin(), indices.end()), out);
+    } else {
+        writeRuns(indices, out);
+    }
+    writeRuns(temperatures, out);
+    writeRuns(colors, out);
+}
+
+static bool readLayer(const char*& p, const char* end, MaterialInstance* layer) {
+    uint16_t paletteSize;
+    if(!get(p, end, &paletteSize) || paletteSize == 0) return false;
+    std::vector<uint16_t> palette(paletteSize);
+    for(uint16_t& id : palette) {
+        if(!get(p, end, &id) || id >= Materials::nMaterials) return false;
+    }
+
+    bool badIndex = false;
+    auto setMaterial = [&](int i, uint16_t index) {
+        if(index >= paletteSize) {
+            badIndex = true;
+            index = 0;
+        }
+        layer[i].mat.id = palette[index];
+    };
+    bool ok;
+    if(paletteSize <= 256) {
+        ok = readRuns<uint8_t>(p, end, CHUNK_CELLS, setMaterial);
+    } else {
+        ok = readRuns<uint16_t>(p, end, CHUNK_CELLS, setMaterial);
+    }
+    if(!ok || badIndex) return false;
+
+    if(!readRuns<int16_t>(p, end, CHUNK_CELLS, [&](int i, int16_t t) { layer[i].temperature = t; })) return false;
+    return readRuns<Uint32>(p, end, CHUNK_CELLS, [&](int i, Uint32 c) { layer[i].color = c; });
+}
+
+void ChunkFile::encode(int generationPhase, const MaterialInstance* tiles, const MaterialInstance* layer2, const Uint32* background, bool compress, std::vector<char>& out) {
+    std::vector<char> body;
+    body.reserve(64 * 1024);
+    writeLayer(tiles, body);
+    writeLayer(layer2, body);
+    writeRuns(std::vector<Uint32>(background, background + CHUNK_CELLS), body);
+
+    uint16_t flags = 0;
+    std::vector<char> packed;
+    if(compress) {
+        uLongf packedSize = compressBound((uLong)body.size());
+        packed.resize(packedSize);
+        if(compress2((Bytef*)packed.data(), &packedSize, (const Bytef*)body.data(), (uLong)body.size(), Z_BEST_SPEED) == Z_OK) {
+            packed.resize(packedSize);
+            flags |= CHUNK_FILE_ZLIB;
+        }
+    }
+    const std::vector<char>& stored = (flags & CHUNK_FILE_ZLIB) ? packed : body;
+
+    out.clear();
+    out.reserve(HEADER_SIZE + stored.size());
+    out.insert(out.end(), CHUNK_FILE_MAGIC, CHUNK_FILE_MAGIC + 4);
+    put<uint16_t>(out, CHUNK_FILE_VERSION);
+    put<uint16_t>(out, flags);
+    put<int32_t>(out, generationPhase);
+    put<uint32_t>(out, (uint32_t)body.size());
+    put<uint32_t>(out, (uint32_t)stored.size());
+    out.insert(out.end(), stored.begin(), stored.end());
+}
+
+// copies the cells of one layer of an old raw file field by field, returns false on an unknown material
+template<typename Cell> static bool readRawLayer(const char* p, MaterialInstance* layer) {
+    for(int i = 0; i < CHUNK_CELLS; i++) {
+        Cell c;
+        memcpy(&c, p + i * sizeof(Cell), sizeof(Cell));
+        if(c.index >= (Uint32)Materials::nMaterials) return false;
+        int32_t t = c.temperature;
+        if(t > INT16_MAX) t = INT16_MAX;
+        if(t < INT16_MIN) t = INT16_MIN;
+        layer[i].mat.id = (uint16_t)c.index;
+        layer[i].temperature = (int16_t)t;
+        layer[i].color = c.color;
+    }
+    return true;
+}
+
+// the old format: the generation phase as a line of text, then raw tiles, layer2 and background
+// the first saves used 12 byte cells (MaterialInstanceDataV0), later ones 8 byte cells, told apart by the size
+static bool decodeRaw(const char* data, size_t size, int* generationPhase, MaterialInstance* tiles, MaterialInstance* layer2, Uint32* background) {
+    const char* nl = (const char*)memchr(data, '\n', size < 16 ? size : 16);
+    if(nl == nullptr) return false;
+    *generationPhase = atoi(std::string(data, nl).c_str());
+    if(tiles == nullptr) return true;
+
+    const char* p = nl + 1;
+    size_t rest = (size_t)(data + size - p);
+    size_t backgroundSize = CHUNK_CELLS * sizeof(Uint32);
+    if(rest == CHUNK_CELLS * sizeof(MaterialInstanceDataV0) * 2 + backgroundSize) {
+        size_t layerSize = CHUNK_CELLS * sizeof(MaterialInstanceDataV0);
+        if(!readRawLayer<MaterialInstanceDataV0>(p, tiles) || !readRawLayer<MaterialInstanceDataV0>(p + layerSize, layer2)) return false;
+        memcpy(background, p + layerSize * 2, backgroundSize);
+        return true;
+    }
+
+    size_t layerSize = CHUNK_CELLS * sizeof(MaterialInstanceData);
+    if(rest != layerSize * 2 + backgroundSize) return false;
+    if(!readRawLayer<MaterialInstanceData>(p, tiles) || !readRawLayer<MaterialInstanceData>(p + layerSize, layer2)) return false;
+    memcpy(background, p + layerSize * 2, backgroundSize);
+    return true;
+}
+
+bool ChunkFile::decodePhase(const char* data, size_t size, int* generationPhase) {
+    if(size >= 4 && memcmp(data, CHUNK_FILE_MAGIC, 4) == 0) {
+        if(size < HEADER_SIZE) return false;
+        memcpy(generationPhase, data + 8, sizeof(int32_t));
+        return true;
+    }
+    return decodeRaw(data, size, generationPhase, nullptr, nullptr, nullptr);
+}
+
+bool ChunkFile::decode(const char* data, size_t size, int* generationPhase, MaterialInstance* tiles, MaterialInstance* layer2, Uint32* background, std::vector<char>& scratch) {
+    if(size < 4 || memcmp(data, CHUNK_FILE_MAGIC, 4) != 0) return decodeRaw(data, size, generationPhase, tiles, layer2, background);
+
+    const char* p = data + 4;
+    const char* end = data + size;
+    uint16_t version, flags;
+    int32_t phase;
+    uint32_t bodySize, storedSize;
+    if(!get(p, end, &version) || !get(p, end, &flags) || !get(p, end, &phase) || !get(p, end, &bodySize) || !get(p, end, &storedSize)) return false;
+    if(version > CHUNK_FILE_VERSION || (size_t)(end - p) < storedSize) return false;
+    // a damaged header mustn't make us allocate whatever it says
+    if(bodySize > BODY_MAX) return false;
+
+    if(flags & CHUNK_FILE_ZLIB) {
+        if(scratch.size() < bodySize) scratch.resize(bodySize);
+        uLongf unpackedSize = bodySize;
+        if(uncompress((Bytef*)scratch.data(), &unpackedSize, (const Bytef*)p, storedSize) != Z_OK || unpackedSize != bodySize) return false;
+        p = scratch.data();
+        end = p + bodySize;
+    } else {
+        end = p + storedSize;
+    }
+
+    if(!readLayer(p, end, tiles)) return false;
+    if(!readLayer(p, end, layer2)) return false;
+    if(!readRuns<Uint32>(p, end, CHUNK_CELLS, [&](int i, Uint32 c) { background[i] = c; })) return false;
+
+    *generationPhase = phase;
+    return true;
+}
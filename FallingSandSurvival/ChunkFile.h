@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifndef INC_MaterialInstance
+#include "MaterialInstance.h"
+#endif // !INC_MaterialInstance
+
+#define INC_ChunkFile
+
+// chunk files start with this, the old raw ones start with the generation phase as text
+#define CHUNK_FILE_MAGIC "FSSC"
+#define CHUNK_FILE_VERSION 1
+// flag: the body is zlib compressed
+#define CHUNK_FILE_ZLIB 1
+
+// the binary chunk format, a fixed header followed by the body:
+// tiles and layer2, each as a palette of the materials in it and runs of palette indices, temperatures and colors,
+// then runs of background colors
+// runs are a 16 bit count with the top bit set for count copies of one value, or clear for count values as they are
+class ChunkFile {
+public:
+    // magic, version, flags, generation phase, body size, stored body size
+    static const int HEADER_SIZE = 20;
+
+    static void encode(int generationPhase, const MaterialInstance* tiles, const MaterialInstance* layer2, const Uint32* background, bool compress, std::vector<char>& out);
+    // only reads the header, returns false if the data isn't a chunk
+    static bool decodePhase(const char* data, size_t size, int* generationPhase);
+    // decodes into arrays of CHUNK_W * CHUNK_H cells, old raw files included
+    // compressed bodies are inflated into scratch, keep it around between calls to save the allocation
+    // returns false if the data is damaged
+    static bool decode(const char* data, size_t size, int* generationPhase, MaterialInstance* tiles, MaterialInstance* layer2, Uint32* background, std::vector<char>& scratch);
+};
@@ -0,0 +1,80 @@
+
+#include "ChunkLoader.h"
+#include "world.h"
+
+#include <algorithm>
+#include <exception>
+
+#define BUILD_WITH_EASY_PROFILER
+#include <easy/profiler.h>
+
+ChunkLoader::ChunkLoader(World* world, int threads) : pool(threads) {
+    this->world = world;
+    scratch.resize(threads);
+}
+
+ChunkLoader::~ChunkLoader() {
+    pool.stop(true);
+
+    Loaded* l = loaded.exchange(nullptr);
+    while(l) {
+        Loaded* next = l->next;
+        delete l;
+        l = next;
+    }
+}
+
+void ChunkLoader::queue(Chunk* ch, bool populate, bool render) {
+    queued.insert(key(ch->x, ch->y));
+
+    pool.push([this, ch, populate, render](int id) {
+        EASY_BLOCK("load chunk");
+        Loaded* l = new Loaded();
+        l->chunk = ch;
+        l->populate = populate;
+        l->render = render;
+        try {
+            world->loadChunk(ch, populate, render, scratch[id]);
+        } catch(std::exception& e) {
+            logError("Failed to load chunk {} {}: {}", ch->x, ch->y, e.what());
+            l->failed = true;
+        } catch(...) {
+            logError("Failed to load chunk {} {}", ch->x, ch->y);
+            l->failed = true;
+        }
+        EASY_END_BLOCK;
+
+        // push onto the stack, the main thread only ever takes the whole stack so there is no ABA
+        l->next = loaded.load(std::memory_order_relaxed);
+        while(!loaded.compare_exchange_weak(l->next, l, std::memory_order_release, std::memory_order_relaxed)) {}
+    });
+}
+
+void ChunkLoader::takeLoaded(std::vector<Chunk*>& out, std::vector<Failed>& failed) {
+    Loaded* l = loaded.exchange(nullptr, std::memory_order_acquire);
+    if(l == nullptr) return;
+
+    // the stack is newest first
+    size_t first = out.size();
+    while(l) {
+        Loaded* next = l->next;
+        uint64_t k = key(l->chunk->x, l->chunk->y);
+        queued.erase(k);
+        if(l->failed) {
+            int attempts = ++failures[k];
+            // once it's given up on, coming back to it later starts over
+            if(attempts >= CHUNK_LOAD_ATTEMPTS) failures.erase(k);
+            failed.push_back({l->chunk, l->populate, l->render, attempts});
+        } else {
+            failures.erase(k);
+            out.push_back(l->chunk);
+        }
+        delete l;
+        l = next;
+    }
+    std::reverse(out.begin() + first, out.end());
+}
+
+void ChunkLoader::finish() {
+    pool.stop(true);
+}
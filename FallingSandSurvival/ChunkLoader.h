@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "lib/CTPL-ctpl_v.0.0.2/ctpl_stl.h"
+
+#define INC_ChunkLoader
+
+// times a chunk is loaded before giving up on it when its worker keeps throwing
+#define CHUNK_LOAD_ATTEMPTS 3
+
+class World;
+class Chunk;
+
+// loads chunks on a pool of workers: read, decode, or else generate and populate phase 0, see World::loadChunk
+// each worker keeps its own buffer for inflating chunk files
+// finished chunks are pushed onto a lock-free stack, the main thread takes them off with takeLoaded
+// everything but the workers themselves is main thread only
+class ChunkLoader {
+    class Loaded {
+    public:
+        Chunk* chunk;
+        bool populate;
+        bool render;
+        // the worker threw, it already logged why
+        bool failed = false;
+        Loaded* next;
+    };
+
+    World* world;
+    ctpl::thread_pool pool;
+    // decode buffer of each worker
+    std::vector<std::vector<char>> scratch;
+    // chunks finished by the workers, newest first
+    std::atomic<Loaded*> loaded {nullptr};
+    // chunks queued and not taken yet
+    std::unordered_set<uint64_t> queued;
+    // times each chunk failed to load, until it loads
+    std::unordered_map<uint64_t, int> failures;
+
+    static uint64_t key(int x, int y) {
+        return (uint64_t)(uint32_t)x << 32 | (uint32_t)y;
+    }
+
+public:
+    // a chunk whose worker threw, with what it was queued with
+    class Failed {
+    public:
+        Chunk* chunk;
+        bool populate;
+        bool render;
+        // failed loads of this chunk so far, this one included
+        int attempts;
+    };
+
+    ChunkLoader(World* world, int threads);
+    // waits for the workers, chunks they loaded that weren't taken are leaked, call finish and takeLoaded first
+    ~ChunkLoader();
+
+    // the chunk mustn't be in chunkCache, nothing else may touch it until it comes out of takeLoaded
+    void queue(Chunk* ch, bool populate, bool render);
+    bool isLoading(int x, int y) {
+        return queued.count(key(x, y)) != 0;
+    }
+    // chunks queued and not taken yet
+    int size() {
+        return (int)queued.size();
+    }
+    // appends the chunks finished since the last call, in the order they finished
+    // chunks that failed to load go to failed instead, in whatever state the worker left them
+    void takeLoaded(std::vector<Chunk*>& out, std::vector<Failed>& failed);
+    // waits until every queued chunk is loaded, nothing can be queued after
+    void finish();
+};
@@ -0,0 +1,113 @@
+
+#include "ChunkWriter.h"
+#include "ChunkFile.h"
+
+#include <cstdio>
+#include <fstream>
+
+#define BUILD_WITH_EASY_PROFILER
+#include <easy/profiler.h>
+
+ChunkWriter::ChunkWriter() {
+    thread = std::thread(&ChunkWriter::run, this);
+}
+
+ChunkWriter::~ChunkWriter() {
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stop = true;
+    }
+    changed.notify_all();
+    thread.join();
+}
+
+void ChunkWriter::queue(std::shared_ptr<ChunkSnapshot> snapshot) {
+    EASY_FUNCTION();
+    uint64_t k = key(snapshot->x, snapshot->y);
+
+    std::unique_lock<std::mutex> lock(mtx);
+    // replacing a waiting snapshot doesn't make the queue any longer
+    changed.wait(lock, [&]() {
+        if(order.size() < CHUNK_WRITE_QUEUE) return true;
+        auto it = pending.find(k);
+        return it != pending.end() && it->second.waiting;
+    });
+
+    Entry& e = pending[k];
+    // the snapshot it replaces may have been the one to remove the old file
+    if(e.waiting && e.snapshot->removeOwnFile) snapshot->removeOwnFile = true;
+    e.snapshot = snapshot;
+    if(!e.waiting) {
+        e.waiting = true;
+        order.push_back(k);
+    }
+    lock.unlock();
+    changed.notify_all();
+}
+
+std::shared_ptr<const ChunkSnapshot> ChunkWriter::find(int x, int y) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = pending.find(key(x, y));
+    if(it == pending.end()) return nullptr;
+    return it->second.snapshot;
+}
+
+void ChunkWriter::flush() {
+    EASY_FUNCTION();
+    std::unordered_set<RegionFile*> sync;
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        changed.wait(lock, [&]() { return order.empty() && busy == 0; });
+        sync.swap(touched);
+    }
+    for(RegionFile* r : sync) r->sync();
+}
+
+void ChunkWriter::run() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while(true) {
+        changed.wait(lock, [&]() { return stop || !order.empty(); });
+        if(order.empty()) return;
+
+        uint64_t k = order.front();
+        order.pop_front();
+        Entry& e = pending[k];
+        e.waiting = false;
+        std::shared_ptr<const ChunkSnapshot> s = e.snapshot;
+        busy++;
+        lock.unlock();
+        changed.notify_all();
+
+        save(*s);
+
+        lock.lock();
+        busy--;
+        if(s->region) touched.insert(s->region);
+        // keep it if a newer snapshot came in while this one was saved
+        auto it = pending.find(k);
+        if(it != pending.end() && it->second.snapshot == s) pending.erase(it);
+        changed.notify_all();
+    }
+}
+
+void ChunkWriter::save(const ChunkSnapshot& snapshot) {
+    EASY_FUNCTION();
+
+    EASY_BLOCK("encode");
+    std::vector<char> data;
+    ChunkFile::encode(snapshot.generationPhase, snapshot.tiles.data(), snapshot.layer2.data(), snapshot.background.data(), true, data);
+    EASY_END_BLOCK;
+
+    if(snapshot.region) {
+        snapshot.region->write(RegionFile::local(snapshot.x), RegionFile::local(snapshot.y), data.data(), data.size());
+        // the region has it now
+        if(snapshot.removeOwnFile) std::remove(snapshot.fname.c_str());
+        return;
+    }
+
+    std::ofstream myfile;
+    myfile.open(snapshot.fname, std::ios::binary);
+    myfile.write(data.data(), data.size());
+    myfile.close();
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#ifndef INC_MaterialInstance
+#include "MaterialInstance.h"
+#endif // !INC_MaterialInstance
+
+#include "RegionFile.h"
+
+#define INC_ChunkWriter
+
+// most chunks waiting to be saved at once, Chunk::write blocks until the writer catches up past this
+#define CHUNK_WRITE_QUEUE 64
+
+// a copy of a chunk as it was when Chunk::write was called
+class ChunkSnapshot {
+public:
+    int x = 0;
+    int y = 0;
+    int generationPhase = 0;
+    RegionFile* region = nullptr;
+    // the chunk's own file, written if it has no region, and removed once the region has it if removeOwnFile is set
+    std::string fname;
+    bool removeOwnFile = false;
+    std::vector<MaterialInstance> tiles;
+    std::vector<MaterialInstance> layer2;
+    std::vector<Uint32> background;
+};
+
+// saves chunks on its own thread so waiting on the disk never shows up as a frame hitch
+// a chunk saved again before the writer got to it replaces the waiting copy, so it's only written once
+// until a chunk is on disk find() returns its snapshot, reads have to check it before the files
+class ChunkWriter {
+    class Entry {
+    public:
+        std::shared_ptr<const ChunkSnapshot> snapshot;
+        // in order, the writer hasn't taken this snapshot yet
+        bool waiting = false;
+    };
+
+    std::mutex mtx;
+    std::condition_variable changed;
+    // the newest snapshot of each chunk that isn't on disk yet
+    std::unordered_map<uint64_t, Entry> pending;
+    // chunks with a waiting snapshot, oldest first
+    std::deque<uint64_t> order;
+    // snapshots the writer is saving right now
+    int busy = 0;
+    // regions written to since the last flush
+    std::unordered_set<RegionFile*> touched;
+    bool stop = false;
+    std::thread thread;
+
+    static uint64_t key(int x, int y) {
+        return (uint64_t)(uint32_t)x << 32 | (uint32_t)y;
+    }
+    void run();
+
+public:
+    ChunkWriter();
+    // saves everything still waiting
+    ~ChunkWriter();
+
+    // takes ownership of the snapshot
+    void queue(std::shared_ptr<ChunkSnapshot> snapshot);
+    // the snapshot of the chunk that is waiting to be saved, or nullptr if the files are up to date
+    std::shared_ptr<const ChunkSnapshot> find(int x, int y);
+    // returns once everything queued before it is saved and synced to disk, call before quitting
+    void flush();
+
+    // encodes and writes the snapshot on the calling thread
+    static void save(const ChunkSnapshot& snapshot);
+};
@@ -9,9 +9,10 @@
 
 class DefaultGenerator : public WorldGenerator {
 
-    int getBaseHeight(World* world, int x, Chunk* ch) {
+    int getBaseHeight(World* world, int x) {
 
-        Biome* b = world->getBiomeAt(ch, x, 0);
+        // not the cached getBiomeAt(Chunk*, ...), chunks are generated on ChunkLoader workers while chunkCache changes
+        Biome* b = world->getBiomeAt(x, 0);
 
         if(b->id == Biomes::DEFAULT.id) {
             //return 0;
@@ -34,15 +35,8 @@ class DefaultGenerator : public WorldGenerator {
         int sum = 0;
 
         int smoothDist = CHUNK_W / 2;
-        int lchx = (int)floor((x - smoothDist) / (float)CHUNK_W);
-
-        Chunk* lch = world->chunkCache[lchx][0];
         for(int xx = -smoothDist; xx <= smoothDist; xx++) {
-            if(floor((x + xx) / (float)CHUNK_W) != lchx) {
-                lchx = (int)floor((x + xx) / (float)CHUNK_W);
-                lch = world->chunkCache[lchx][0];
-            }
-            sum += getBaseHeight(world, x + xx, lch);
+            sum += getBaseHeight(world, x + xx);
         }
 
         int baseH = sum / (2 * smoothDist + 1);
@@ -437,6 +437,10 @@ int Game::init(int argc, char *argv[]) {
             world = new World();
             world->init((char*)getWorldDir(wn).c_str(), (int)ceil(WIDTH / 3 / (double)CHUNK_W) * CHUNK_W + CHUNK_W * 3, (int)ceil(HEIGHT / 3 / (double)CHUNK_H) * CHUNK_H + CHUNK_H * 3, target, &audioEngine, networkMode);
 
+            // the new world doesn't know which particle pixels the old one left behind
+            memset(pixelsParticles_ar, 0, pixelsParticles.size());
+            GPU_UpdateImageBytes(textureParticles, NULL, pixelsParticles_ar, world->width * 4);
+
             EASY_BLOCK("Queue chunk loading");
             logInfo("Queueing chunk loading...");
             for(int x = -CHUNK_W * 4; x < world->width + CHUNK_W * 4; x += CHUNK_W) {
@@ -525,7 +529,7 @@ int Game::init(int argc, char *argv[]) {
         #pragma region
         logInfo("Setting up debug UI...");
         EASY_BLOCK("init debug UI");
-        debugUI = new UI(new SDL_Rect {WIDTH - 200 - 15, 25, 200, 350});
+        debugUI = new UI(new SDL_Rect {WIDTH - 200 - 15, 25, 200, 370});
         debugUI->background = new SolidBackground(0x80000000);
         debugUI->drawBorder = true;
 
@@ -578,6 +582,7 @@ int Game::init(int argc, char *argv[]) {
         SETTINGS_CHECK(draw_light_map, [](bool checked) {});
         SETTINGS_CHECK(draw_temperature_map, [](bool checked) {});
         SETTINGS_CHECK(draw_shaders, [](bool checked) {});
+        SETTINGS_CHECK(draw_particle_stats, [](bool checked) {});
         SETTINGS_CHECK(tick_world, [](bool checked) {});
         SETTINGS_CHECK(tick_box2d, [](bool checked) {});
         SETTINGS_CHECK(tick_temperature, [](bool checked) {});
@@ -838,6 +843,7 @@ int Game::init(int argc, char *argv[]) {
     EASY_BLOCK("init threadpools");
     updateDirtyPool = new ctpl::thread_pool(6);
     rotateVectorsPool = new ctpl::thread_pool(3);
+    simPool = new ctpl::thread_pool(1);
     EASY_END_BLOCK;
     #pragma endregion
 
@@ -940,6 +946,10 @@ int Game::run(int argc, char *argv[]) {
         now = Time::millis();
         long long deltaTime = now - lastTime;
 
+        // the last tick's sim ran while the last frame rendered, it has to be done before anything else touches the world
+        finishTick();
+        publishRenderState();
+
         if(networkMode != NetworkMode::SERVER) {
             #if BUILD_WITH_DISCORD
             if(discordAPI) {
@@ -1026,8 +1036,7 @@ int Game::run(int argc, char *argv[]) {
                     }
 
                     // erase from rigidbodies
-                    // this copies the vector
-                    vector<RigidBody*> rbs = world->rigidBodies;
+                    vector<RigidBody*> rbs = world->rigidBodiesNear(x - 3, y - 3, x + 3, y + 3);
 
                     for(size_t i = 0; i < rbs.size(); i++) {
                         RigidBody* cur = rbs[i];
@@ -1114,7 +1123,7 @@ int Game::run(int argc, char *argv[]) {
                                 int x = (int)((mx - ofsX - camX) / scale);
                                 int y = (int)((my - ofsY - camY) / scale);
 
-                                vector<RigidBody*> rbs = world->rigidBodies; // copy
+                                vector<RigidBody*> rbs = world->rigidBodiesNear(x - 3, y - 3, x + 3, y + 3);
                                 for(size_t i = 0; i < rbs.size(); i++) {
                                     RigidBody* cur = rbs[i];
 
@@ -1330,7 +1339,7 @@ int Game::run(int argc, char *argv[]) {
                         int y = (int)((my - ofsY - camY) / scale);
 
                         bool swapped = false;
-                        vector<RigidBody*> rbs = world->rigidBodies; // copy;
+                        vector<RigidBody*> rbs = world->rigidBodiesNear(x - 3, y - 3, x + 3, y + 3);
                         for(size_t i = 0; i < rbs.size(); i++) {
                             RigidBody* cur = rbs[i];
 
@@ -1406,8 +1415,10 @@ int Game::run(int argc, char *argv[]) {
         }
 
         while(now - lastTick > mspt) {
-            if(Settings::tick_world && networkMode != NetworkMode::CLIENT)
+            if(Settings::tick_world && networkMode != NetworkMode::CLIENT) {
+                finishTick();
                 tick();
+            }
             target = realTarget;
             lastTick = now;
             tickTime++;
@@ -1509,6 +1520,11 @@ int Game::run(int argc, char *argv[]) {
 exit:
     EASY_END_BLOCK; // frame??
 
+    if(simResult.valid()) simResult.get();
+
+    // make sure every chunk save reached the disk
+    if(world != nullptr && world->chunkWriter != nullptr) world->chunkWriter->flush();
+
     // release resources & shutdown
     #pragma region
     delete objectDelete;
@@ -1746,7 +1762,7 @@ void Game::updateFrameEarly() {
 
                 MaterialInstance mat = world->player->heldItem->carry[world->player->heldItem->carry.size() - 1];
                 world->player->heldItem->carry.pop_back();
-                world->addParticle(new Particle(mat, (float)x, (float)y, (float)(world->player->vx / 2 + (rand() % 10 - 5) / 10.0f + 1.5f * (float)cos((world->player->holdAngle + 180) * 3.1415f / 180.0f)), (float)(world->player->vy / 2 + -(rand() % 5 + 5) / 10.0f + 1.5f * (float)sin((world->player->holdAngle + 180) * 3.1415f / 180.0f)), 0, (float)0.1));
+                world->addParticle(Particle(mat, (float)x, (float)y, (float)(world->player->vx / 2 + (rand() % 10 - 5) / 10.0f + 1.5f * (float)cos((world->player->holdAngle + 180) * 3.1415f / 180.0f)), (float)(world->player->vy / 2 + -(rand() % 5 + 5) / 10.0f + 1.5f * (float)sin((world->player->holdAngle + 180) * 3.1415f / 180.0f)), 0, (float)0.1));
 
                 int i = world->player->heldItem->carry.size();
                 i = (int)((i / (float)world->player->heldItem->capacity) * world->player->heldItem->fill.size());
@@ -1877,7 +1893,7 @@ void Game::tick() {
         if(world) {
             // tick chunkloading
             world->frame();
-            if(world->readyToMerge.size() == 0 && fadeOutStart == 0) {
+            if(world->readyToMerge.size() == 0 && world->chunkLoader->size() == 0 && fadeOutStart == 0) {
                 fadeOutStart = now;
                 fadeOutLength = 250;
                 fadeOutCallback = [&]() {
@@ -1916,16 +1932,16 @@ void Game::tick() {
 				pix_ar[ofs + 3] = c_a;
 
                 if(world->dirty[i]) {
-                    if(world->tiles[i].mat->physicsType == PhysicsType::AIR) {
+                    if(Materials::PHYSICS_TYPE[world->tiles[i].mat.id] == PhysicsType::AIR) {
                         UCH_SET_PIXEL(pixels_ar, offset, 0, 0, 0, SDL_ALPHA_TRANSPARENT);
                     } else {
                         Uint32 color = world->tiles[i].color;
-                        UCH_SET_PIXEL(pixels_ar, offset, (color >> 0) & 0xff, (color >> 8) & 0xff, (color >> 16) & 0xff, world->tiles[i].mat->alpha);
+                        UCH_SET_PIXEL(pixels_ar, offset, (color >> 0) & 0xff, (color >> 8) & 0xff, (color >> 16) & 0xff, Materials::ALPHA[world->tiles[i].mat.id]);
                     }
                 }
 
                 if(world->layer2Dirty[i]) {
-                    if(world->layer2[i].mat->physicsType == PhysicsType::AIR) {
+                    if(Materials::PHYSICS_TYPE[world->layer2[i].mat.id] == PhysicsType::AIR) {
                         if(Settings::draw_background_grid) {
                             Uint32 color = ((i) % 2) == 0 ? 0x888888 : 0x444444;
                             UCH_SET_PIXEL(pixelsLayer2_ar, offset, (color >> 0) & 0xff, (color >> 8) & 0xff, (color >> 16) & 0xff, SDL_ALPHA_OPAQUE);
@@ -1935,7 +1951,7 @@ void Game::tick() {
                         continue;
                     }
                     Uint32 color = world->layer2[i].color;
-                    UCH_SET_PIXEL(pixelsLayer2_ar, offset, (color >> 0) & 0xff, (color >> 8) & 0xff, (color >> 16) & 0xff, world->layer2[i].mat->alpha);
+                    UCH_SET_PIXEL(pixelsLayer2_ar, offset, (color >> 0) & 0xff, (color >> 8) & 0xff, (color >> 16) & 0xff, Materials::ALPHA[world->layer2[i].mat.id]);
                 }
 
                 if(world->backgroundDirty[i]) {
@@ -1947,6 +1963,9 @@ void Game::tick() {
             EASY_END_BLOCK;
             #pragma endregion
 
+            // the tiles are about to move, so wake what changed before the flags are cleared
+            world->wakeDirty();
+
             EASY_BLOCK("memset");
             memset(world->dirty, false, world->width * world->height);
             memset(world->layer2Dirty, false, world->width * world->height);
@@ -2135,6 +2154,7 @@ pixels[ofs + 3] = SDL_ALPHA_TRANSPARENT;
             float c = cos(cur->body->GetAngle());
 
             std::vector<std::pair<int, int>> checkDirs = {{0, 0}, {1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+            cur->stamped.assign(cur->matWidth * cur->matHeight, {INT_MIN, INT_MIN});
 
             for(int tx = 0; tx < cur->matWidth; tx++) {
                 for(int ty = 0; ty < cur->matHeight; ty++) {
@@ -2153,21 +2173,24 @@ pixels[ofs + 3] = SDL_ALPHA_TRANSPARENT;
                         if(world->tiles[wxd + wyd * world->width].mat->physicsType == PhysicsType::AIR) {
                             world->tiles[wxd + wyd * world->width] = rmat;
                             world->dirty[wxd + wyd * world->width] = true;
+                            cur->stamped[tx + ty * cur->matWidth] = {wxd - world->loadZone.x, wyd - world->loadZone.y};
                             //objectDelete[wxd + wyd * world->width] = true;
                             break;
                         } else if(world->tiles[wxd + wyd * world->width].mat->physicsType == PhysicsType::SAND) {
-                            world->addParticle(new Particle(world->tiles[wxd + wyd * world->width], (float)wxd, (float)(wyd - 3), (float)((rand() % 10 - 5) / 10.0f), (float)(-(rand() % 5 + 5) / 10.0f), 0, (float)0.1));
+                            world->addParticle(Particle(world->tiles[wxd + wyd * world->width], (float)wxd, (float)(wyd - 3), (float)((rand() % 10 - 5) / 10.0f), (float)(-(rand() % 5 + 5) / 10.0f), 0, (float)0.1));
                             world->tiles[wxd + wyd * world->width] = rmat;
                             //objectDelete[wxd + wyd * world->width] = true;
                             world->dirty[wxd + wyd * world->width] = true;
+                            cur->stamped[tx + ty * cur->matWidth] = {wxd - world->loadZone.x, wyd - world->loadZone.y};
                             cur->body->SetLinearVelocity({cur->body->GetLinearVelocity().x * (float)0.99, cur->body->GetLinearVelocity().y * (float)0.99});
                             cur->body->SetAngularVelocity(cur->body->GetAngularVelocity() * (float)0.98);
                             break;
                         } else if(world->tiles[wxd + wyd * world->width].mat->physicsType == PhysicsType::SOUP) {
-                            world->addParticle(new Particle(world->tiles[wxd + wyd * world->width], (float)wxd, (float)(wyd - 3), (float)((rand() % 10 - 5) / 10.0f), (float)(-(rand() % 5 + 5) / 10.0f), 0, (float)0.1));
+                            world->addParticle(Particle(world->tiles[wxd + wyd * world->width], (float)wxd, (float)(wyd - 3), (float)((rand() % 10 - 5) / 10.0f), (float)(-(rand() % 5 + 5) / 10.0f), 0, (float)0.1));
                             world->tiles[wxd + wyd * world->width] = rmat;
                             //objectDelete[wxd + wyd * world->width] = true;
                             world->dirty[wxd + wyd * world->width] = true;
+                            cur->stamped[tx + ty * cur->matWidth] = {wxd - world->loadZone.x, wyd - world->loadZone.y};
                             cur->body->SetLinearVelocity({cur->body->GetLinearVelocity().x * (float)0.998, cur->body->GetLinearVelocity().y * (float)0.998});
                             cur->body->SetAngularVelocity(cur->body->GetAngularVelocity() * (float)0.99);
                             break;
@@ -2203,6 +2226,11 @@ pixels[ofs + 3] = SDL_ALPHA_TRANSPARENT;
         for(size_t i = 0; i < world->entities.size(); i++) {
             Entity cur = *world->entities[i];
 
+            // the OBJECT tiles get removed again after the tick, keep the cells around them awake
+            int ex = (int)(cur.x + world->loadZone.x);
+            int ey = (int)(cur.y + world->loadZone.y);
+            world->wakeArea(ex - 1, ey - 1, ex + cur.hw, ey + cur.hh);
+
             for(int tx = 0; tx < cur.hw; tx++) {
                 for(int ty = 0; ty < cur.hh; ty++) {
 
@@ -2213,7 +2241,7 @@ pixels[ofs + 3] = SDL_ALPHA_TRANSPARENT;
                         world->tiles[wx + wy * world->width] = Tiles::OBJECT;
                         objectDelete[wx + wy * world->width] = true;
                     } else if(world->tiles[wx + wy * world->width].mat->physicsType == PhysicsType::SAND || world->tiles[wx + wy * world->width].mat->physicsType == PhysicsType::SOUP) {
-                        world->addParticle(new Particle(world->tiles[wx + wy * world->width], (float)(wx + rand() % 3 - 1 - cur.vx), (float)(wy - abs(cur.vy)), (float)(-cur.vx / 4 + (rand() % 10 - 5) / 5.0f), (float)(-cur.vy / 4 + -(rand() % 5 + 5) / 5.0f), 0, (float)0.1));
+                        world->addParticle(Particle(world->tiles[wx + wy * world->width], (float)(wx + rand() % 3 - 1 - cur.vx), (float)(wy - abs(cur.vy)), (float)(-cur.vx / 4 + (rand() % 10 - 5) / 5.0f), (float)(-cur.vy / 4 + -(rand() % 5 + 5) / 5.0f), 0, (float)0.1));
                         world->tiles[wx + wy * world->width] = Tiles::OBJECT;
                         objectDelete[wx + wy * world->width] = true;
                         world->dirty[wx + wy * world->width] = true;
@@ -2223,584 +2251,605 @@ pixels[ofs + 3] = SDL_ALPHA_TRANSPARENT;
         }
         #pragma endregion
 
-        if(Settings::tick_world && world->readyToMerge.size() == 0) {
+        if(Controls::DEBUG_TICK->get()) {
             world->tick();
         }
 
-        if(Controls::DEBUG_TICK->get()) {
-            world->tick();
+        // the cell simulation runs on simPool while the main loop renders the frame,
+        // everything after it (and everything that touches the gpu) waits for finishTick
+        if(Settings::tick_world && world->readyToMerge.size() == 0) {
+            world->tickChunks();
+            simResult = simPool->push([&](int id) {
+                world->tickCells();
+            });
         }
+        tickPending = true;
+    }
+}
 
-        // player movement
-        #pragma region
-        if(world->player) {
-            if(Controls::PLAYER_UP->get() && !Controls::DEBUG_DRAW->get()) {
-                if(world->player->ground) {
-                    world->player->vy = -4;
-                    audioEngine.PlayEvent("event:/Jump");
-                }
-            }
+void Game::finishTick() {
+    if(!tickPending) return;
+    tickPending = false;
 
-            world->player->vy += (float)(((Controls::PLAYER_UP->get() && !Controls::DEBUG_DRAW->get()) ? (world->player->vy > -1 ? -0.8 : -0.35) : 0) + (Controls::PLAYER_DOWN->get() ? 0.1 : 0));
-            if(Controls::PLAYER_UP->get() && !Controls::DEBUG_DRAW->get()) {
-                audioEngine.SetEventParameter("event:/Fly", "Intensity", 1);
-                for(int i = 0; i < 4; i++) {
-                    Particle* p = new Particle(Tiles::createLava(), (float)(world->player->x + world->loadZone.x + world->player->hw / 2 + rand() % 5 - 2 + world->player->vx), (float)(world->player->y + world->loadZone.y + world->player->hh + world->player->vy), (float)((rand() % 10 - 5) / 10.0f + world->player->vx / 2.0f), (float)((rand() % 10) / 10.0f + 1 + world->player->vy / 2.0f), 0, (float)0.025);
-                    p->temporary = true;
-                    p->lifetime = 120;
-                    world->addParticle(p);
-                }
-            } else {
-                audioEngine.SetEventParameter("event:/Fly", "Intensity", 0);
-            }
+    EASY_FUNCTION(GAME_PROFILER_COLOR);
 
-            if(world->player->vy > 0) {
-                audioEngine.SetEventParameter("event:/Wind", "Wind", (float)(world->player->vy / 12.0));
-            } else {
-                audioEngine.SetEventParameter("event:/Wind", "Wind", 0);
-            }
+    if(simResult.valid()) {
+        EASY_BLOCK("wait for sim", THREAD_WAIT_PROFILER_COLOR);
+        simResult.get();
+        EASY_END_BLOCK;
 
-            world->player->vx += (float)((Controls::PLAYER_LEFT->get() ? (world->player->vx > 0 ? -0.4 : -0.2) : 0) + (Controls::PLAYER_RIGHT->get() ? (world->player->vx < 0 ? 0.4 : 0.2) : 0));
-            if(!Controls::PLAYER_LEFT->get() && !Controls::PLAYER_RIGHT->get()) world->player->vx *= (float)(world->player->ground ? 0.85 : 0.96);
-            if(world->player->vx > 4.5) world->player->vx = 4.5;
-            if(world->player->vx < -4.5) world->player->vx = -4.5;
-        } else {
-            if(state == INGAME) {
-                freeCamX += (float)((Controls::PLAYER_LEFT->get() ? -5 : 0) + (Controls::PLAYER_RIGHT->get() ? 5 : 0));
-                freeCamY += (float)((Controls::PLAYER_UP->get() ? -5 : 0) + (Controls::PLAYER_DOWN->get() ? 5 : 0));
-            } else {
+        world->tickPhysicsCheck();
+    }
 
+    // player movement
+    #pragma region
+    if(world->player) {
+        if(Controls::PLAYER_UP->get() && !Controls::DEBUG_DRAW->get()) {
+            if(world->player->ground) {
+                world->player->vy = -4;
+                audioEngine.PlayEvent("event:/Jump");
             }
         }
-        #pragma endregion
-
-        #pragma region
-        if(world->player) {
-            desCamX = (float)(-(mx - (WIDTH / 2)) / 4);
-            desCamY = (float)(-(my - (HEIGHT / 2)) / 4);
-
-            world->player->holdAngle = (float)(atan2(desCamY, desCamX) * 180 / (float)W_PI);
 
-            desCamX = 0;
-            desCamY = 0;
+        world->player->vy += (float)(((Controls::PLAYER_UP->get() && !Controls::DEBUG_DRAW->get()) ? (world->player->vy > -1 ? -0.8 : -0.35) : 0) + (Controls::PLAYER_DOWN->get() ? 0.1 : 0));
+        if(Controls::PLAYER_UP->get() && !Controls::DEBUG_DRAW->get()) {
+            audioEngine.SetEventParameter("event:/Fly", "Intensity", 1);
+            for(int i = 0; i < 4; i++) {
+                Particle p(Tiles::createLava(), (float)(world->player->x + world->loadZone.x + world->player->hw / 2 + rand() % 5 - 2 + world->player->vx), (float)(world->player->y + world->loadZone.y + world->player->hh + world->player->vy), (float)((rand() % 10 - 5) / 10.0f + world->player->vx / 2.0f), (float)((rand() % 10) / 10.0f + 1 + world->player->vy / 2.0f), 0, (float)0.025);
+                p.temporary = true;
+                p.lifetime = 120;
+                world->addParticle(p);
+            }
         } else {
-            desCamX = 0;
-            desCamY = 0;
+            audioEngine.SetEventParameter("event:/Fly", "Intensity", 0);
         }
-        #pragma endregion
-
-        #pragma region
-        if(world->player) {
-            if(world->player->heldItem) {
-                if(world->player->heldItem->getFlag(ItemFlags::VACUUM)) {
-                    if(world->player->holdVacuum) {
-
-                        int wcx = (int)((WIDTH / 2 - ofsX - camX) / scale);
-                        int wcy = (int)((HEIGHT / 2 - ofsY - camY) / scale);
-
-                        int wmx = (int)((mx - ofsX - camX) / scale);
-                        int wmy = (int)((my - ofsY - camY) / scale);
-
-                        int mdx = wmx - wcx;
-                        int mdy = wmy - wcy;
-
-                        int distSq = mdx * mdx + mdy * mdy;
-                        if(distSq <= 256 * 256) {
-
-                            int sind = -1;
-                            bool inObject = true;
-                            world->forLine(wcx, wcy, wmx, wmy, [&](int ind) {
-                                if(world->tiles[ind].mat->physicsType == PhysicsType::OBJECT) {
-                                    if(!inObject) {
-                                        sind = ind;
-                                        return true;
-                                    }
-                                } else {
-                                    inObject = false;
-                                }
-
-                                if(world->tiles[ind].mat->physicsType == PhysicsType::SOLID || world->tiles[ind].mat->physicsType == PhysicsType::SAND || world->tiles[ind].mat->physicsType == PhysicsType::SOUP) {
-                                    sind = ind;
-                                    return true;
-                                }
-                                return false;
-                            });
 
-                            int x = sind == -1 ? wmx : sind % world->width;
-                            int y = sind == -1 ? wmy : sind / world->width;
+        if(world->player->vy > 0) {
+            audioEngine.SetEventParameter("event:/Wind", "Wind", (float)(world->player->vy / 12.0));
+        } else {
+            audioEngine.SetEventParameter("event:/Wind", "Wind", 0);
+        }
 
-                            std::function<void(MaterialInstance, int, int)> makeParticle = [&](MaterialInstance tile, int xPos, int yPos) {
-                                Particle* par = new Particle(tile, xPos, yPos, 0, 0, 0, (float)0.01f);
-                                par->vx = (rand() % 10 - 5) / 5.0f * 1.0f;
-                                par->vy = (rand() % 10 - 5) / 5.0f * 1.0f;
-                                par->ax = -par->vx / 10.0f;
-                                par->ay = -par->vy / 10.0f;
-                                if(par->ay == 0 && par->ax == 0) par->ay = 0.01f;
+        world->player->vx += (float)((Controls::PLAYER_LEFT->get() ? (world->player->vx > 0 ? -0.4 : -0.2) : 0) + (Controls::PLAYER_RIGHT->get() ? (world->player->vx < 0 ? 0.4 : 0.2) : 0));
+        if(!Controls::PLAYER_LEFT->get() && !Controls::PLAYER_RIGHT->get()) world->player->vx *= (float)(world->player->ground ? 0.85 : 0.96);
+        if(world->player->vx > 4.5) world->player->vx = 4.5;
+        if(world->player->vx < -4.5) world->player->vx = -4.5;
+    } else {
+        if(state == INGAME) {
+            freeCamX += (float)((Controls::PLAYER_LEFT->get() ? -5 : 0) + (Controls::PLAYER_RIGHT->get() ? 5 : 0));
+            freeCamY += (float)((Controls::PLAYER_UP->get() ? -5 : 0) + (Controls::PLAYER_DOWN->get() ? 5 : 0));
+        } else {
 
-                                //par->targetX = world->player->x + world->player->hw / 2 + world->loadZone.x;
-                                //par->targetY = world->player->y + world->player->hh / 2 + world->loadZone.y;
-                                //par->targetForce = 0.35f;
+        }
+    }
+    #pragma endregion
 
-                                par->lifetime = 6;
+    #pragma region
+    if(world->player) {
+        desCamX = (float)(-(mx - (WIDTH / 2)) / 4);
+        desCamY = (float)(-(my - (HEIGHT / 2)) / 4);
 
-                                par->phase = true;
+        world->player->holdAngle = (float)(atan2(desCamY, desCamX) * 180 / (float)W_PI);
 
-                                world->player->heldItem->vacuumParticles.push_back(par);
+        desCamX = 0;
+        desCamY = 0;
+    } else {
+        desCamX = 0;
+        desCamY = 0;
+    }
+    #pragma endregion
 
-                                par->killCallback = [&]() {
-                                    auto v = world->player->heldItem->vacuumParticles;
-                                    v.erase(std::remove(v.begin(), v.end(), par), v.end());
-                                };
+    #pragma region
+    if(world->player) {
+        if(world->player->heldItem) {
+            if(world->player->heldItem->getFlag(ItemFlags::VACUUM)) {
+                if(world->player->holdVacuum) {
 
-                                world->addParticle(par);
-                            };
+                    int wcx = (int)((WIDTH / 2 - ofsX - camX) / scale);
+                    int wcy = (int)((HEIGHT / 2 - ofsY - camY) / scale);
 
-                            int rad = 5;
-                            for(int xx = -rad; xx <= rad; xx++) {
-                                for(int yy = -rad; yy <= rad; yy++) {
-                                    if((yy == -rad || yy == rad) && (xx == -rad || x == rad)) continue;
+                    int wmx = (int)((mx - ofsX - camX) / scale);
+                    int wmy = (int)((my - ofsY - camY) / scale);
 
-                                    MaterialInstance tile = world->tiles[(x + xx) + (y + yy) * world->width];
-                                    if(tile.mat->physicsType == PhysicsType::SOLID || tile.mat->physicsType == PhysicsType::SAND || tile.mat->physicsType == PhysicsType::SOUP) {
-                                        makeParticle(tile, x + xx, y + yy);
-                                        world->tiles[(x + xx) + (y + yy) * world->width] = Tiles::NOTHING;
-                                        //world->tiles[(x + xx) + (y + yy) * world->width] = Tiles::createFire();
-                                        world->dirty[(x + xx) + (y + yy) * world->width] = true;
-                                    }
+                    int mdx = wmx - wcx;
+                    int mdy = wmy - wcy;
 
+                    int distSq = mdx * mdx + mdy * mdy;
+                    if(distSq <= 256 * 256) {
 
+                        int sind = -1;
+                        bool inObject = true;
+                        world->forLine(wcx, wcy, wmx, wmy, [&](int ind) {
+                            if(world->tiles[ind].mat->physicsType == PhysicsType::OBJECT) {
+                                if(!inObject) {
+                                    sind = ind;
+                                    return true;
                                 }
+                            } else {
+                                inObject = false;
                             }
 
-                            world->particles.erase(std::remove_if(world->particles.begin(), world->particles.end(), [&](Particle* cur) {
-                                if(cur->targetForce == 0 && !cur->phase) {
-                                    int rad = 5;
-                                    for(int xx = -rad; xx <= rad; xx++) {
-                                        for(int yy = -rad; yy <= rad; yy++) {
-                                            if((yy == -rad || yy == rad) && (xx == -rad || x == rad)) continue;
+                            if(world->tiles[ind].mat->physicsType == PhysicsType::SOLID || world->tiles[ind].mat->physicsType == PhysicsType::SAND || world->tiles[ind].mat->physicsType == PhysicsType::SOUP) {
+                                sind = ind;
+                                return true;
+                            }
+                            return false;
+                        });
+
+                        int x = sind == -1 ? wmx : sind % world->width;
+                        int y = sind == -1 ? wmy : sind / world->width;
+
+                        std::function<void(MaterialInstance, int, int)> makeParticle = [&](MaterialInstance tile, int xPos, int yPos) {
+                            Particle par(tile, xPos, yPos, 0, 0, 0, (float)0.01f);
+                            par.vx = (rand() % 10 - 5) / 5.0f * 1.0f;
+                            par.vy = (rand() % 10 - 5) / 5.0f * 1.0f;
+                            par.ax = -par.vx / 10.0f;
+                            par.ay = -par.vy / 10.0f;
+                            if(par.ay == 0 && par.ax == 0) par.ay = 0.01f;
+
+                            //par.targetX = world->player->x + world->player->hw / 2 + world->loadZone.x;
+                            //par.targetY = world->player->y + world->player->hh / 2 + world->loadZone.y;
+                            //par.targetForce = 0.35f;
+
+                            par.lifetime = 6;
+
+                            par.phase = true;
+
+                            int slot = world->addParticle(par);
+                            if(slot >= 0) world->player->heldItem->vacuumParticles.push_back(world->particles.track(slot));
+                        };
+
+                        int rad = 5;
+                        for(int xx = -rad; xx <= rad; xx++) {
+                            for(int yy = -rad; yy <= rad; yy++) {
+                                if((yy == -rad || yy == rad) && (xx == -rad || x == rad)) continue;
+
+                                MaterialInstance tile = world->tiles[(x + xx) + (y + yy) * world->width];
+                                if(tile.mat->physicsType == PhysicsType::SOLID || tile.mat->physicsType == PhysicsType::SAND || tile.mat->physicsType == PhysicsType::SOUP) {
+                                    makeParticle(tile, x + xx, y + yy);
+                                    world->tiles[(x + xx) + (y + yy) * world->width] = Tiles::NOTHING;
+                                    //world->tiles[(x + xx) + (y + yy) * world->width] = Tiles::createFire();
+                                    world->markDirty((x + xx) + (y + yy) * world->width);
+                                }
 
-                                            if(((int)(cur->x) == (x + xx)) && ((int)(cur->y) == (y + yy))) {
 
-                                                cur->vx = (rand() % 10 - 5) / 5.0f * 1.0f;
-                                                cur->vy = (rand() % 10 - 5) / 5.0f * 1.0f;
-                                                cur->ax = -cur->vx / 10.0f;
-                                                cur->ay = -cur->vy / 10.0f;
-                                                if(cur->ay == 0 && cur->ax == 0) cur->ay = 0.01f;
+                            }
+                        }
 
-                                                //par->targetX = world->player->x + world->player->hw / 2 + world->loadZone.x;
-                                                //par->targetY = world->player->y + world->player->hh / 2 + world->loadZone.y;
-                                                //par->targetForce = 0.35f;
+                        ParticleStore& parts = world->particles;
+                        std::vector<int> nearby;
+                        world->particlesNear(x - rad, y - rad, x + rad, y + rad, nearby);
+                        for(int i : nearby) {
+                            if(parts.targetForce[i] == 0 && !parts.phase[i]) {
+                                for(int xx = -rad; xx <= rad; xx++) {
+                                    for(int yy = -rad; yy <= rad; yy++) {
+                                        if((yy == -rad || yy == rad) && (xx == -rad || x == rad)) continue;
 
-                                                cur->lifetime = 6;
+                                        if(((int)(parts.x[i]) == (x + xx)) && ((int)(parts.y[i]) == (y + yy))) {
 
-                                                cur->phase = true;
+                                            parts.vx[i] = (rand() % 10 - 5) / 5.0f * 1.0f;
+                                            parts.vy[i] = (rand() % 10 - 5) / 5.0f * 1.0f;
+                                            parts.ax[i] = -parts.vx[i] / 10.0f;
+                                            parts.ay[i] = -parts.vy[i] / 10.0f;
+                                            if(parts.ay[i] == 0 && parts.ax[i] == 0) parts.ay[i] = 0.01f;
 
-                                                world->player->heldItem->vacuumParticles.push_back(cur);
+                                            //parts.targetX[i] = world->player->x + world->player->hw / 2 + world->loadZone.x;
+                                            //parts.targetY[i] = world->player->y + world->player->hh / 2 + world->loadZone.y;
+                                            //parts.targetForce[i] = 0.35f;
 
-                                                cur->killCallback = [&]() {
-                                                    auto v = world->player->heldItem->vacuumParticles;
-                                                    v.erase(std::remove(v.begin(), v.end(), cur), v.end());
-                                                };
+                                            parts.lifetime[i] = 6;
 
-                                                return false;
-                                            }
+                                            parts.phase[i] = true;
+
+                                            world->player->heldItem->vacuumParticles.push_back(parts.track(i));
                                         }
                                     }
                                 }
+                            }
+                        }
 
-                                return false;
-                            }), world->particles.end());
-
-                            vector<RigidBody*> rbs = world->rigidBodies;
-
-                            for(size_t i = 0; i < rbs.size(); i++) {
-                                RigidBody* cur = rbs[i];
-                                if(cur->body->IsEnabled()) {
-                                    float s = sin(-cur->body->GetAngle());
-                                    float c = cos(-cur->body->GetAngle());
-                                    bool upd = false;
-                                    for(int xx = -rad; xx <= rad; xx++) {
-                                        for(int yy = -rad; yy <= rad; yy++) {
-                                            if((yy == -rad || yy == rad) && (xx == -rad || x == rad)) continue;
-                                            // rotate point
+                        vector<RigidBody*> rbs = world->rigidBodiesNear(x - rad, y - rad, x + rad, y + rad);
 
-                                            float tx = x + xx - cur->body->GetPosition().x;
-                                            float ty = y + yy - cur->body->GetPosition().y;
+                        for(size_t i = 0; i < rbs.size(); i++) {
+                            RigidBody* cur = rbs[i];
+                            if(cur->body->IsEnabled()) {
+                                float s = sin(-cur->body->GetAngle());
+                                float c = cos(-cur->body->GetAngle());
+                                bool upd = false;
+                                for(int xx = -rad; xx <= rad; xx++) {
+                                    for(int yy = -rad; yy <= rad; yy++) {
+                                        if((yy == -rad || yy == rad) && (xx == -rad || x == rad)) continue;
+                                        // rotate point
 
-                                            int ntx = (int)(tx * c - ty * s);
-                                            int nty = (int)(tx * s + ty * c);
+                                        float tx = x + xx - cur->body->GetPosition().x;
+                                        float ty = y + yy - cur->body->GetPosition().y;
 
-                                            if(ntx >= 0 && nty >= 0 && ntx < cur->surface->w && nty < cur->surface->h) {
-                                                Uint32 pixel = PIXEL(cur->surface, ntx, nty);
-                                                if(((pixel >> 24) & 0xff) != 0x00) {
-                                                    PIXEL(cur->surface, ntx, nty) = 0x00000000;
-                                                    upd = true;
+                                        int ntx = (int)(tx * c - ty * s);
+                                        int nty = (int)(tx * s + ty * c);
 
-                                                    makeParticle(MaterialInstance(&Materials::GENERIC_SOLID, pixel), (x + xx), (y + yy));
-                                                }
+                                        if(ntx >= 0 && nty >= 0 && ntx < cur->surface->w && nty < cur->surface->h) {
+                                            Uint32 pixel = PIXEL(cur->surface, ntx, nty);
+                                            if(((pixel >> 24) & 0xff) != 0x00) {
+                                                PIXEL(cur->surface, ntx, nty) = 0x00000000;
+                                                upd = true;
 
+                                                makeParticle(MaterialInstance(&Materials::GENERIC_SOLID, pixel), (x + xx), (y + yy));
                                             }
+
                                         }
                                     }
+                                }
 
-                                    if(upd) {
-                                        GPU_FreeImage(cur->texture);
-                                        cur->texture = GPU_CopyImageFromSurface(cur->surface);
-                                        GPU_SetImageFilter(cur->texture, GPU_FILTER_NEAREST);
-                                        //world->updateRigidBodyHitbox(cur);
-                                        cur->needsUpdate = true;
-                                    }
+                                if(upd) {
+                                    GPU_FreeImage(cur->texture);
+                                    cur->texture = GPU_CopyImageFromSurface(cur->surface);
+                                    GPU_SetImageFilter(cur->texture, GPU_FILTER_NEAREST);
+                                    //world->updateRigidBodyHitbox(cur);
+                                    cur->needsUpdate = true;
                                 }
                             }
-
                         }
-                    }
-
-                    if(world->player->heldItem->vacuumParticles.size() > 0) {
-                        world->player->heldItem->vacuumParticles.erase(std::remove_if(world->player->heldItem->vacuumParticles.begin(), world->player->heldItem->vacuumParticles.end(), [&](Particle* cur) {
-
-                            if(cur->lifetime <= 0) {
-                                cur->targetForce = 0.45f;
-                                cur->targetX = world->player->x + world->player->hw / 2 + world->loadZone.x;
-                                cur->targetY = world->player->y + world->player->hh / 2 + world->loadZone.y;
-                                cur->ax = 0;
-                                cur->ay = 0.01f;
-                            }
 
-                            float tdx = cur->targetX - cur->x;
-                            float tdy = cur->targetY - cur->y;
-
-                            if(tdx * tdx + tdy * tdy < 10 * 10) {
-                                cur->temporary = true;
-                                cur->lifetime = 0;
-                                //logDebug("vacuum {}", cur->tile.mat->name.c_str());
-                                return true;
-                            }
-
-                            return false;
-                        }), world->player->heldItem->vacuumParticles.end());
                     }
-
                 }
-            }
-        }
-        #pragma endregion
 
-        // update particles, tickObjects, update dirty
-        // TODO: this is not entirely thread safe since tickParticles changes World::tiles and World::dirty
-        #pragma region
-        EASY_BLOCK("post World::tick");
-        bool hadDirty = false;
-        bool hadLayer2Dirty = false;
-        bool hadBackgroundDirty = false;
-        bool hadFire = false;
-
-        int pitch;
-        //void* vdpixels_ar = texture->data;
-        //unsigned char* dpixels_ar = (unsigned char*)vdpixels_ar;
-        unsigned char* dpixels_ar = pixels_ar;
-        unsigned char* dpixelsFire_ar = pixelsFire_ar;
+                if(world->player->heldItem->vacuumParticles.size() > 0) {
+                    ParticleStore& parts = world->particles;
+                    std::vector<uint32_t>& vacuum = world->player->heldItem->vacuumParticles;
 
-        for(size_t i = 0; i < world->rigidBodies.size(); i++) {
-            RigidBody* cur = world->rigidBodies[i];
-            if(cur == nullptr) continue;
-            if(cur->surface == nullptr) continue;
-            if(!cur->body->IsEnabled()) continue;
+                    // forget particles that died since last tick before their ids get reused
+                    for(uint32_t id : parts.killed) {
+                        vacuum.erase(std::remove(vacuum.begin(), vacuum.end(), id), vacuum.end());
+                    }
 
-            float x = cur->body->GetPosition().x;
-            float y = cur->body->GetPosition().y;
+                    vacuum.erase(std::remove_if(vacuum.begin(), vacuum.end(), [&](uint32_t id) {
+                        int i = parts.find(id);
+                        if(i < 0) return true;
 
-            float s = sin(cur->body->GetAngle());
-            float c = cos(cur->body->GetAngle());
+                        if(parts.lifetime[i] <= 0) {
+                            parts.targetForce[i] = 0.45f;
+                            parts.targetX[i] = world->player->x + world->player->hw / 2 + world->loadZone.x;
+                            parts.targetY[i] = world->player->y + world->player->hh / 2 + world->loadZone.y;
+                            parts.ax[i] = 0;
+                            parts.ay[i] = 0.01f;
+                        }
 
-            std::vector<std::pair<int, int>> checkDirs = {{0, 0}, {1, 0}, {-1, 0}, {0, 1}, {0, -1}};
-            for(int tx = 0; tx < cur->matWidth; tx++) {
-                for(int ty = 0; ty < cur->matHeight; ty++) {
-                    MaterialInstance rmat = cur->tiles[tx + ty * cur->matWidth];
-                    if(rmat.mat->id == Materials::GENERIC_AIR.id) continue;
+                        float tdx = parts.targetX[i] - parts.x[i];
+                        float tdy = parts.targetY[i] - parts.y[i];
 
-                    // rotate point
-                    int wx = (int)(tx * c - ty * s + x);
-                    int wy = (int)(tx * s + ty * c + y);
+                        if(tdx * tdx + tdy * tdy < 10 * 10) {
+                            parts.temporary[i] = true;
+                            parts.lifetime[i] = 0;
+                            //logDebug("vacuum {}", parts.tile[i].mat->name.c_str());
+                            return true;
+                        }
 
-                    bool found = false;
-                    for(auto& dir : checkDirs) {
-                        int wxd = wx + dir.first;
-                        int wyd = wy + dir.second;
+                        return false;
+                    }), vacuum.end());
+                }
 
-                        if(wxd < 0 || wyd < 0 || wxd >= world->width || wyd >= world->height) continue;
-                        if(world->tiles[wxd + wyd * world->width] == rmat) {
-                            cur->tiles[tx + ty * cur->matWidth] = world->tiles[wxd + wyd * world->width];
-                            world->tiles[wxd + wyd * world->width] = Tiles::NOTHING;
-                            world->dirty[wxd + wyd * world->width] = true;
-                            found = true;
-                            break;
-                        }
+            }
+        }
+    }
+    world->particles.clearKilled();
+    #pragma endregion
+
+    // update particles, tickObjects, update dirty
+    // the sim is done by now, the particles and objects run side by side but only the particles touch World::tiles and World::dirty
+    #pragma region
+    EASY_BLOCK("post World::tick");
+    bool hadDirty = false;
+    bool hadLayer2Dirty = false;
+    bool hadBackgroundDirty = false;
+    bool hadFire = false;
+    // first and last dirty index of each layer, only the rows between them get cleared and uploaded
+    int dirtyFirst = 0, dirtyLast = 0;
+    int layer2DirtyFirst = 0, layer2DirtyLast = 0;
+    int backgroundDirtyFirst = 0, backgroundDirtyLast = 0;
+
+    int pitch;
+    //void* vdpixels_ar = texture->data;
+    //unsigned char* dpixels_ar = (unsigned char*)vdpixels_ar;
+    unsigned char* dpixels_ar = pixels_ar;
+    unsigned char* dpixelsFire_ar = pixelsFire_ar;
+
+    for(size_t i = 0; i < world->rigidBodies.size(); i++) {
+        RigidBody* cur = world->rigidBodies[i];
+        if(cur == nullptr) continue;
+        if(cur->surface == nullptr) continue;
+        if(!cur->body->IsEnabled()) continue;
+
+        float x = cur->body->GetPosition().x;
+        float y = cur->body->GetPosition().y;
+
+        float s = sin(cur->body->GetAngle());
+        float c = cos(cur->body->GetAngle());
+
+        for(int tx = 0; tx < cur->matWidth; tx++) {
+            for(int ty = 0; ty < cur->matHeight; ty++) {
+                MaterialInstance rmat = cur->tiles[tx + ty * cur->matWidth];
+                if(rmat.mat->id == Materials::GENERIC_AIR.id) continue;
+
+                // rotate point
+                int wx = (int)(tx * c - ty * s + x);
+                int wy = (int)(tx * s + ty * c + y);
+
+                // take back the cell this tile was stamped into, if the sim left it there
+                bool found = false;
+                std::pair<int, int> at = tx + ty * cur->matWidth < cur->stamped.size() ? cur->stamped[tx + ty * cur->matWidth] : std::make_pair(INT_MIN, INT_MIN);
+                if(at.first != INT_MIN) {
+                    int wxd = at.first + world->loadZone.x;
+                    int wyd = at.second + world->loadZone.y;
+                    if(wxd >= 0 && wyd >= 0 && wxd < world->width && wyd < world->height && world->tiles[wxd + wyd * world->width] == rmat) {
+                        cur->tiles[tx + ty * cur->matWidth] = world->tiles[wxd + wyd * world->width];
+                        world->tiles[wxd + wyd * world->width] = Tiles::NOTHING;
+                        world->markDirty(wxd + wyd * world->width);
+                        found = true;
                     }
+                }
 
-                    if(!found) {
-                        if(world->tiles[wx + wy * world->width].mat->id == Materials::GENERIC_AIR.id) {
-                            cur->tiles[tx + ty * cur->matWidth] = Tiles::NOTHING;
-                        }
+                if(!found) {
+                    if(world->tiles[wx + wy * world->width].mat->id == Materials::GENERIC_AIR.id) {
+                        cur->tiles[tx + ty * cur->matWidth] = Tiles::NOTHING;
                     }
                 }
             }
+        }
 
-            for(int x = 0; x < cur->surface->w; x++) {
-                for(int y = 0; y < cur->surface->h; y++) {
-                    MaterialInstance mat = cur->tiles[x + y * cur->surface->w];
-                    if(mat.mat->id == Materials::GENERIC_AIR.id) {
-                        PIXEL(cur->surface, x, y) = 0x00000000;
-                    } else {
-                        PIXEL(cur->surface, x, y) = (mat.mat->alpha << 24) + mat.color;
-                    }
+        for(int x = 0; x < cur->surface->w; x++) {
+            for(int y = 0; y < cur->surface->h; y++) {
+                MaterialInstance mat = cur->tiles[x + y * cur->surface->w];
+                if(mat.mat->id == Materials::GENERIC_AIR.id) {
+                    PIXEL(cur->surface, x, y) = 0x00000000;
+                } else {
+                    PIXEL(cur->surface, x, y) = (mat.mat->alpha << 24) + mat.color;
                 }
             }
+        }
 
-            cur->texture = GPU_CopyImageFromSurface(cur->surface);
-            GPU_SetImageFilter(cur->texture, GPU_FILTER_NEAREST);
+        cur->texture = GPU_CopyImageFromSurface(cur->surface);
+        GPU_SetImageFilter(cur->texture, GPU_FILTER_NEAREST);
 
-            cur->needsUpdate = true;
-        }
+        cur->needsUpdate = true;
+    }
 
-        std::vector<std::future<void>> results = {};
+    std::vector<std::future<void>> results = {};
 
-        results.push_back(updateDirtyPool->push([&](int id) {
-            EASY_BLOCK("particles");
-            //SDL_SetRenderTarget(renderer, textureParticles);
-            void* particlePixels = pixelsParticles_ar;
-            EASY_BLOCK("memset");
-            memset(particlePixels, 0, world->width * world->height * 4);
-            EASY_END_BLOCK; // memset
-            world->renderParticles((unsigned char**)&particlePixels);
-            world->tickParticles();
+    results.push_back(updateDirtyPool->push([&](int id) {
+        EASY_BLOCK("particles");
+        //SDL_SetRenderTarget(renderer, textureParticles);
+        void* particlePixels = pixelsParticles_ar;
+        world->renderParticles((unsigned char**)&particlePixels);
+        world->tickParticles();
+
+        //SDL_SetRenderTarget(renderer, NULL);
+        EASY_END_BLOCK; // particles
+    }));
 
-            //SDL_SetRenderTarget(renderer, NULL);
-            EASY_END_BLOCK; // particles
+    if(Settings::tick_box2d && world->readyToMerge.size() == 0) {
+        results.push_back(updateDirtyPool->push([&](int id) {
+            world->tickObjects();
         }));
+    }
 
-        if(Settings::tick_box2d && world->readyToMerge.size() == 0) {
-            results.push_back(updateDirtyPool->push([&](int id) {
-                world->tickObjects();
-            }));
-        }
+    EASY_BLOCK("wait for threads", THREAD_WAIT_PROFILER_COLOR);
+    for(int i = 0; i < results.size(); i++) {
+        results[i].get();
+    }
+    EASY_END_BLOCK;
 
-        EASY_BLOCK("wait for threads", THREAD_WAIT_PROFILER_COLOR);
-        for(int i = 0; i < results.size(); i++) {
-            results[i].get();
-        }
-        EASY_END_BLOCK;
+    // particles and bodies are done moving for this tick
+    world->updateSpatialGrid();
 
-        if(tickTime % 10 == 0) world->tickObjectsMesh();
+    if(tickTime % 10 == 0) world->tickObjectsMesh();
 
-        results.clear();
-        results.push_back(updateDirtyPool->push([&](int id) {
-            EASY_BLOCK("dirty");
-            for(int i = 0; i < world->width * world->height; i++) {
-                const unsigned int offset = i * 4;
+    results.clear();
+    results.push_back(updateDirtyPool->push([&](int id) {
+        EASY_BLOCK("dirty");
+        for(int i = 0; i < world->width * world->height; i++) {
+            const unsigned int offset = i * 4;
 
-                if(world->dirty[i]) {
-                    hadDirty = true;
-                    if(world->tiles[i].mat->physicsType == PhysicsType::AIR) {
-                        dpixels_ar[offset + 0] = 0;        // b
-                        dpixels_ar[offset + 1] = 0;        // g
-                        dpixels_ar[offset + 2] = 0;        // r
-                        dpixels_ar[offset + 3] = SDL_ALPHA_TRANSPARENT;    // a		
-
-                        dpixelsFire_ar[offset + 0] = 0;        // b
-                        dpixelsFire_ar[offset + 1] = 0;        // g
-                        dpixelsFire_ar[offset + 2] = 0;        // r
-                        dpixelsFire_ar[offset + 3] = SDL_ALPHA_TRANSPARENT;    // a		
-                    } else {
-                        Uint32 color = world->tiles[i].color;
-                        //float br = world->light[i];
-                        dpixels_ar[offset + 2] = ((color >> 0) & 0xff);        // b
-                        dpixels_ar[offset + 1] = ((color >> 8) & 0xff);        // g
-                        dpixels_ar[offset + 0] = ((color >> 16) & 0xff);        // r
-                        dpixels_ar[offset + 3] = world->tiles[i].mat->alpha;    // a
-
-                        if(world->tiles[i].mat->id == Materials::FIRE.id) {
-                            dpixelsFire_ar[offset + 2] = ((color >> 0) & 0xff);        // b
-                            dpixelsFire_ar[offset + 1] = ((color >> 8) & 0xff);        // g
-                            dpixelsFire_ar[offset + 0] = ((color >> 16) & 0xff);        // r
-                            dpixelsFire_ar[offset + 3] = world->tiles[i].mat->alpha;    // a
-                            hadFire = true;
-                        }
+            if(world->dirty[i]) {
+                if(!hadDirty) dirtyFirst = i;
+                dirtyLast = i;
+                hadDirty = true;
+                if(Materials::PHYSICS_TYPE[world->tiles[i].mat.id] == PhysicsType::AIR) {
+                    dpixels_ar[offset + 0] = 0;        // b
+                    dpixels_ar[offset + 1] = 0;        // g
+                    dpixels_ar[offset + 2] = 0;        // r
+                    dpixels_ar[offset + 3] = SDL_ALPHA_TRANSPARENT;    // a		
+
+                    dpixelsFire_ar[offset + 0] = 0;        // b
+                    dpixelsFire_ar[offset + 1] = 0;        // g
+                    dpixelsFire_ar[offset + 2] = 0;        // r
+                    dpixelsFire_ar[offset + 3] = SDL_ALPHA_TRANSPARENT;    // a		
+                } else {
+                    Uint32 color = world->tiles[i].color;
+                    //float br = world->light[i];
+                    dpixels_ar[offset + 2] = ((color >> 0) & 0xff);        // b
+                    dpixels_ar[offset + 1] = ((color >> 8) & 0xff);        // g
+                    dpixels_ar[offset + 0] = ((color >> 16) & 0xff);        // r
+                    dpixels_ar[offset + 3] = Materials::ALPHA[world->tiles[i].mat.id];    // a
+
+                    if(world->tiles[i].mat->id == Materials::FIRE.id) {
+                        dpixelsFire_ar[offset + 2] = ((color >> 0) & 0xff);        // b
+                        dpixelsFire_ar[offset + 1] = ((color >> 8) & 0xff);        // g
+                        dpixelsFire_ar[offset + 0] = ((color >> 16) & 0xff);        // r
+                        dpixelsFire_ar[offset + 3] = Materials::ALPHA[world->tiles[i].mat.id];    // a
+                        hadFire = true;
                     }
                 }
             }
-            EASY_END_BLOCK;
-        }));
+        }
+        EASY_END_BLOCK;
+    }));
 
-        //void* vdpixelsLayer2_ar = textureLayer2->data;
-        //unsigned char* dpixelsLayer2_ar = (unsigned char*)vdpixelsLayer2_ar;
-        unsigned char* dpixelsLayer2_ar = pixelsLayer2_ar;
-        results.push_back(updateDirtyPool->push([&](int id) {
-            EASY_BLOCK("layer2Dirty");
-            for(int i = 0; i < world->width * world->height; i++) {
-                /*for (int x = 0; x < world->width; x++) {
-                    for (int y = 0; y < world->height; y++) {*/
-                    //const unsigned int i = x + y * world->width;
-                const unsigned int offset = i * 4;
-                if(world->layer2Dirty[i]) {
-                    hadLayer2Dirty = true;
-                    if(world->layer2[i].mat->physicsType == PhysicsType::AIR) {
-                        if(Settings::draw_background_grid) {
-                            Uint32 color = ((i) % 2) == 0 ? 0x888888 : 0x444444;
-                            dpixelsLayer2_ar[offset + 2] = (color >> 0) & 0xff;        // b
-                            dpixelsLayer2_ar[offset + 1] = (color >> 8) & 0xff;        // g
-                            dpixelsLayer2_ar[offset + 0] = (color >> 16) & 0xff;       // r
-                            dpixelsLayer2_ar[offset + 3] = SDL_ALPHA_OPAQUE;			 // a
-                            continue;
-                        } else {
-                            dpixelsLayer2_ar[offset + 0] = 0;        // b
-                            dpixelsLayer2_ar[offset + 1] = 0;        // g
-                            dpixelsLayer2_ar[offset + 2] = 0;        // r
-                            dpixelsLayer2_ar[offset + 3] = SDL_ALPHA_TRANSPARENT;    // a
-                            continue;
-                        }
+    //void* vdpixelsLayer2_ar = textureLayer2->data;
+    //unsigned char* dpixelsLayer2_ar = (unsigned char*)vdpixelsLayer2_ar;
+    unsigned char* dpixelsLayer2_ar = pixelsLayer2_ar;
+    results.push_back(updateDirtyPool->push([&](int id) {
+        EASY_BLOCK("layer2Dirty");
+        for(int i = 0; i < world->width * world->height; i++) {
+            /*for (int x = 0; x < world->width; x++) {
+                for (int y = 0; y < world->height; y++) {*/
+                //const unsigned int i = x + y * world->width;
+            const unsigned int offset = i * 4;
+            if(world->layer2Dirty[i]) {
+                if(!hadLayer2Dirty) layer2DirtyFirst = i;
+                layer2DirtyLast = i;
+                hadLayer2Dirty = true;
+                if(Materials::PHYSICS_TYPE[world->layer2[i].mat.id] == PhysicsType::AIR) {
+                    if(Settings::draw_background_grid) {
+                        Uint32 color = ((i) % 2) == 0 ? 0x888888 : 0x444444;
+                        dpixelsLayer2_ar[offset + 2] = (color >> 0) & 0xff;        // b
+                        dpixelsLayer2_ar[offset + 1] = (color >> 8) & 0xff;        // g
+                        dpixelsLayer2_ar[offset + 0] = (color >> 16) & 0xff;       // r
+                        dpixelsLayer2_ar[offset + 3] = SDL_ALPHA_OPAQUE;			 // a
+                        continue;
+                    } else {
+                        dpixelsLayer2_ar[offset + 0] = 0;        // b
+                        dpixelsLayer2_ar[offset + 1] = 0;        // g
+                        dpixelsLayer2_ar[offset + 2] = 0;        // r
+                        dpixelsLayer2_ar[offset + 3] = SDL_ALPHA_TRANSPARENT;    // a
+                        continue;
                     }
-                    Uint32 color = world->layer2[i].color;
-                    dpixelsLayer2_ar[offset + 2] = (color >> 0) & 0xff;        // b
-                    dpixelsLayer2_ar[offset + 1] = (color >> 8) & 0xff;        // g
-                    dpixelsLayer2_ar[offset + 0] = (color >> 16) & 0xff;        // r
-                    dpixelsLayer2_ar[offset + 3] = world->layer2[i].mat->alpha;    // a
                 }
+                Uint32 color = world->layer2[i].color;
+                dpixelsLayer2_ar[offset + 2] = (color >> 0) & 0xff;        // b
+                dpixelsLayer2_ar[offset + 1] = (color >> 8) & 0xff;        // g
+                dpixelsLayer2_ar[offset + 0] = (color >> 16) & 0xff;        // r
+                dpixelsLayer2_ar[offset + 3] = Materials::ALPHA[world->layer2[i].mat.id];    // a
             }
-            EASY_END_BLOCK;
-        }));
-
-        //void* vdpixelsBackground_ar = textureBackground->data;
-        //unsigned char* dpixelsBackground_ar = (unsigned char*)vdpixelsBackground_ar;
-        unsigned char* dpixelsBackground_ar = pixelsBackground_ar;
-        results.push_back(updateDirtyPool->push([&](int id) {
-            EASY_BLOCK("backgroundDirty");
-            for(int i = 0; i < world->width * world->height; i++) {
-                /*for (int x = 0; x < world->width; x++) {
-                    for (int y = 0; y < world->height; y++) {*/
-                    //const unsigned int i = x + y * world->width;
-                const unsigned int offset = i * 4;
-
-                if(world->backgroundDirty[i]) {
-                    hadBackgroundDirty = true;
-                    Uint32 color = world->background[i];
-                    dpixelsBackground_ar[offset + 2] = (color >> 0) & 0xff;        // b
-                    dpixelsBackground_ar[offset + 1] = (color >> 8) & 0xff;        // g
-                    dpixelsBackground_ar[offset + 0] = (color >> 16) & 0xff;       // r
-                    dpixelsBackground_ar[offset + 3] = (color >> 24) & 0xff;       // a
-                }
-
-                //}
-            }
-            EASY_END_BLOCK;
-        }));
+        }
+        EASY_END_BLOCK;
+    }));
 
-        EASY_BLOCK("objectDelete");
+    //void* vdpixelsBackground_ar = textureBackground->data;
+    //unsigned char* dpixelsBackground_ar = (unsigned char*)vdpixelsBackground_ar;
+    unsigned char* dpixelsBackground_ar = pixelsBackground_ar;
+    results.push_back(updateDirtyPool->push([&](int id) {
+        EASY_BLOCK("backgroundDirty");
         for(int i = 0; i < world->width * world->height; i++) {
             /*for (int x = 0; x < world->width; x++) {
                 for (int y = 0; y < world->height; y++) {*/
                 //const unsigned int i = x + y * world->width;
             const unsigned int offset = i * 4;
 
-            if(objectDelete[i]) {
-                world->tiles[i] = Tiles::NOTHING;
+            if(world->backgroundDirty[i]) {
+                if(!hadBackgroundDirty) backgroundDirtyFirst = i;
+                backgroundDirtyLast = i;
+                hadBackgroundDirty = true;
+                Uint32 color = world->background[i];
+                dpixelsBackground_ar[offset + 2] = (color >> 0) & 0xff;        // b
+                dpixelsBackground_ar[offset + 1] = (color >> 8) & 0xff;        // g
+                dpixelsBackground_ar[offset + 0] = (color >> 16) & 0xff;       // r
+                dpixelsBackground_ar[offset + 3] = (color >> 24) & 0xff;       // a
             }
-        }
-        EASY_END_BLOCK;
 
-        //results.push_back(updateDirtyPool->push([&](int id) {
-
-        //}));
-        EASY_BLOCK("wait for threads", THREAD_WAIT_PROFILER_COLOR);
-        for(int i = 0; i < results.size(); i++) {
-            results[i].get();
+            //}
         }
         EASY_END_BLOCK;
+    }));
 
-        EASY_BLOCK("particle GPU_UpdateImageBytes");
-        GPU_UpdateImageBytes(
-            textureParticles,
-            NULL,
-            &pixelsParticles_ar[0],
-            world->width * 4
-        );
-        EASY_END_BLOCK; // GPU_UpdateImageBytes
+    EASY_BLOCK("objectDelete");
+    for(int i = 0; i < world->width * world->height; i++) {
+        /*for (int x = 0; x < world->width; x++) {
+            for (int y = 0; y < world->height; y++) {*/
+            //const unsigned int i = x + y * world->width;
+        const unsigned int offset = i * 4;
 
-        EASY_BLOCK("dirty memset");
-        if(hadDirty)		   memset(world->dirty, false, world->width * world->height);
-        if(hadLayer2Dirty)	   memset(world->layer2Dirty, false, world->width * world->height);
-        if(hadBackgroundDirty) memset(world->backgroundDirty, false, world->width * world->height);
-        EASY_END_BLOCK;
+        if(objectDelete[i]) {
+            world->tiles[i] = Tiles::NOTHING;
+        }
+    }
+    EASY_END_BLOCK;
 
-        EASY_END_BLOCK; // post World::tick
-        #pragma endregion
+    //results.push_back(updateDirtyPool->push([&](int id) {
 
-        if(Settings::draw_light_map && tickTime % 4 == 0) renderLightmap(world);
-        if(Settings::tick_temperature && tickTime % 4 == 2) {
-            world->tickTemperature();
-        }
-        if(Settings::draw_temperature_map && tickTime % 4 == 0) {
-            renderTemperatureMap(world);
-        }
+    //}));
+    EASY_BLOCK("wait for threads", THREAD_WAIT_PROFILER_COLOR);
+    for(int i = 0; i < results.size(); i++) {
+        results[i].get();
+    }
+    EASY_END_BLOCK;
 
-        EASY_BLOCK("GPU_UpdateImageBytes", GPU_PROFILER_COLOR);
-        if(hadDirty) {
-            GPU_UpdateImageBytes(
-                texture,
-                NULL,
-                &pixels[0],
-                world->width * 4
-            );
-        }
+    EASY_BLOCK("dirty memset");
+    if(hadDirty)		   memset(world->dirty + dirtyFirst, false, dirtyLast - dirtyFirst + 1);
+    if(hadLayer2Dirty)	   memset(world->layer2Dirty + layer2DirtyFirst, false, layer2DirtyLast - layer2DirtyFirst + 1);
+    if(hadBackgroundDirty) memset(world->backgroundDirty + backgroundDirtyFirst, false, backgroundDirtyLast - backgroundDirtyFirst + 1);
+    EASY_END_BLOCK;
 
-        if(hadLayer2Dirty) {
-            GPU_UpdateImageBytes(
-                textureLayer2,
-                NULL,
-                &pixelsLayer2[0],
-                world->width * 4
-            );
-        }
+    EASY_END_BLOCK; // post World::tick
+    #pragma endregion
 
-        if(hadBackgroundDirty) {
-            GPU_UpdateImageBytes(
-                textureBackground,
-                NULL,
-                &pixelsBackground[0],
-                world->width * 4
-            );
-        }
+    if(Settings::draw_light_map && tickTime % 4 == 0) renderLightmap(world);
+    if(Settings::tick_temperature && tickTime % 4 == 2) {
+        world->tickTemperature();
+    }
+    if(Settings::draw_temperature_map && tickTime % 4 == 0) {
+        renderTemperatureMap(world);
+    }
 
-        if(hadFire) {
-            GPU_UpdateImageBytes(
-                textureFire,
-                NULL,
-                &pixelsFire[0],
-                world->width * 4
-            );
-        }
+    EASY_BLOCK("GPU_UpdateImageBytes", GPU_PROFILER_COLOR);
+    // upload the rows spanning [first, last] instead of the whole world
+    auto updateRows = [&](GPU_Image* tex, vector<unsigned char>& px, int first, int last) {
+        int y0 = first / world->width;
+        int y1 = last / world->width;
+        GPU_Rect rect = {0, (float)y0, (float)world->width, (float)(y1 - y0 + 1)};
+        GPU_UpdateImageBytes(
+            tex,
+            &rect,
+            &px[y0 * world->width * 4],
+            world->width * 4
+        );
+    };
 
-        if(Settings::draw_temperature_map) {
-            GPU_UpdateImageBytes(
-                temperatureMap,
-                NULL,
-                &pixelsTemp[0],
-                world->width * 4
-            );
-        }
+    if(hadDirty) updateRows(texture, pixels, dirtyFirst, dirtyLast);
+    if(hadLayer2Dirty) updateRows(textureLayer2, pixelsLayer2, layer2DirtyFirst, layer2DirtyLast);
+    if(hadBackgroundDirty) updateRows(textureBackground, pixelsBackground, backgroundDirtyFirst, backgroundDirtyLast);
+    // fire pixels only change on dirty tiles
+    if(hadFire) updateRows(textureFire, pixelsFire, dirtyFirst, dirtyLast);
+    // only the rows particles were drawn to this tick or the last
+    if(world->particleDirtyLast >= 0) updateRows(textureParticles, pixelsParticles, world->particleDirtyFirst, world->particleDirtyLast);
 
-        /*GPU_UpdateImageBytes(
-            textureObjects,
+    if(Settings::draw_temperature_map) {
+        GPU_UpdateImageBytes(
+            temperatureMap,
             NULL,
-            &pixelsObjects[0],
+            &pixelsTemp[0],
             world->width * 4
-        );*/
-        EASY_END_BLOCK;
+        );
+    }
 
-        if(Settings::tick_box2d && tickTime % 4 == 0) world->updateWorldMesh();
+    /*GPU_UpdateImageBytes(
+        textureObjects,
+        NULL,
+        &pixelsObjects[0],
+        world->width * 4
+    );*/
+    EASY_END_BLOCK;
 
-        EASY_END_BLOCK;
+    if(Settings::tick_box2d && tickTime % 4 == 0) world->updateWorldMesh();
+
+    EASY_END_BLOCK;
+}
+
+void Game::publishRenderState() {
+    EASY_FUNCTION(GAME_PROFILER_COLOR);
+    if(state == LOADING || world == nullptr) return;
+
+    aimSolidSurface = -1;
+    if(world->player && world->player->heldItem != NULL && world->player->heldItem->getFlag(ItemFlags::HAMMER) && !world->player->holdHammer) {
+        aimSolidSurface = getAimSolidSurface(64);
     }
+
+    int msx = (int)((mx - ofsX - camX) / scale);
+    int msy = (int)((my - ofsY - camY) / scale);
+    hoverTileValid = msx >= 0 && msy >= 0 && msx < world->width && msy < world->height;
+    if(hoverTileValid) hoverTile = world->tiles[msx + msy * world->width];
+
+    particleCount = world->particles.size();
+    shownParticleStats = world->particleStats;
 }
 
 void Game::updateFrameLate() {
@@ -2961,7 +3010,7 @@ void Game::renderEarly() {
 
                             GPU_Line(textureEntities->target, world->player->hammerX + dx, world->player->hammerY + dy, world->player->hammerX, world->player->hammerY, {0xff, 0xff, 0x00, 0xff});
                         } else {
-                            int startInd = getAimSolidSurface(64);
+                            int startInd = aimSolidSurface;
 
                             if(startInd != -1) {
                                 int x = startInd % world->width;
@@ -3332,11 +3381,8 @@ void Game::renderLate() {
 
         if(Settings::draw_material_info) {
             EASY_BLOCK("draw material info", RENDER_PROFILER_COLOR);
-            int msx = (int)((mx - ofsX - camX) / scale);
-            int msy = (int)((my - ofsY - camY) / scale);
-
-            if(msx >= 0 && msy >= 0 && msx < world->width && msy < world->height) {
-                MaterialInstance tile = world->tiles[msx + msy * world->width];
+            if(hoverTileValid) {
+                MaterialInstance tile = hoverTile;
                 Drawing::drawText(target, tile.mat->name.c_str(), font16, 2, 2, 0xff, 0xff, 0xff, ALIGN_LEFT);
                 int ln = 0;
                 if(tile.mat->interact) {
@@ -3374,6 +3420,16 @@ void Game::renderLate() {
         Drawing::drawText(target, dt_fps, WIDTH - 4, 2, ALIGN_RIGHT);
         EASY_END_BLOCK; // draw fps
 
+        if(Settings::draw_particle_stats) {
+            EASY_BLOCK("draw particle stats", RENDER_PROFILER_COLOR);
+            char buff[64];
+            snprintf(buff, sizeof(buff), "particles %d / %d", particleCount, Settings::particle_budget);
+            Drawing::drawText(target, buff, font14, WIDTH - 4, 2 + 16, 0xff, 0xff, 0xff, ALIGN_RIGHT);
+            snprintf(buff, sizeof(buff), "deposited %d, dropped %d, merged %d", shownParticleStats.deposited, shownParticleStats.dropped, shownParticleStats.merged);
+            Drawing::drawText(target, buff, font14, WIDTH - 4, 2 + 16 + 12, 0xff, 0xff, 0xff, ALIGN_RIGHT);
+            EASY_END_BLOCK; // draw particle stats
+        }
+
         if(Settings::draw_chunk_state) {
             EASY_BLOCK("draw chunk state", RENDER_PROFILER_COLOR);
             GPU_Rect r = {0 , 0, 10, 10};
@@ -3413,15 +3469,9 @@ void Game::renderLate() {
             int dbgIndex = 1;
 
             char buff1[32];
-            snprintf(buff1, sizeof(buff1), "world->readyToReadyToMerge (%d)", world->readyToReadyToMerge.size());
+            snprintf(buff1, sizeof(buff1), "world->chunkLoader (%d)", world->chunkLoader->size());
             std::string buffAsStdStr1 = buff1;
             Drawing::drawText(target, buffAsStdStr1.c_str(), font14, 2, 2 + (12 * dbgIndex++), 0xff, 0xff, 0xff, ALIGN_LEFT);
-            for(size_t i = 0; i < world->readyToReadyToMerge.size(); i++) {
-                char buff[10];
-                snprintf(buff, sizeof(buff), "    #%d", i);
-                std::string buffAsStdStr = buff;
-                Drawing::drawText(target, buffAsStdStr.c_str(), font14, 2, 2 + (12 * dbgIndex++), 0xff, 0xff, 0xff, ALIGN_LEFT);
-            }
             char buff2[30];
             snprintf(buff2, sizeof(buff2), "world->readyToMerge (%d)", world->readyToMerge.size());
             std::string buffAsStdStr2 = buff2;
@@ -145,6 +145,18 @@ public:
     int ent_prevLoadZoneY = 0;
     ctpl::thread_pool* updateDirtyPool = nullptr;
     ctpl::thread_pool* rotateVectorsPool = nullptr;
+    // runs World::tickCells while the frame renders
+    ctpl::thread_pool* simPool = nullptr;
+    std::future<void> simResult;
+    bool tickPending = false;
+
+    // the bits of the world the overlays show, taken by publishRenderState while the sim isn't running
+    // rendering reads these instead of the world, whose tiles and particles the sim is busy changing
+    int aimSolidSurface = -1;
+    bool hoverTileValid = false;
+    MaterialInstance hoverTile;
+    int particleCount = 0;
+    ParticleStats shownParticleStats;
 
     GPU_Image* lightMap = nullptr;
 
@@ -210,6 +222,8 @@ public:
 
     void updateFrameEarly();
     void tick();
+    void finishTick();
+    void publishRenderState();
     void updateFrameLate();
 
     void renderEarly();
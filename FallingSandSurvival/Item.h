@@ -45,7 +45,7 @@ public:
     std::vector<UInt16Point> fill;
     uint16_t capacity = 0;
 
-    std::vector<Particle*> vacuumParticles;
+    std::vector<uint32_t> vacuumParticles;
 
     Item();
     ~Item();
@@ -1,15 +1,13 @@
 
 #include "MaterialInstance.h"
 
-int MaterialInstance::_curID = 1;
-
-MaterialInstance::MaterialInstance(Material* mat, Uint32 color, int32_t temperature) {
-    this->id = _curID++;
-    this->mat = mat;
+MaterialInstance::MaterialInstance(Material* mat, Uint32 color, int32_t temperature) : mat(mat) {
     this->color = color;
-    this->temperature = temperature;
+    if(temperature > INT16_MAX) temperature = INT16_MAX;
+    if(temperature < INT16_MIN) temperature = INT16_MIN;
+    this->temperature = (int16_t)temperature;
 }
 
 bool MaterialInstance::operator==(const MaterialInstance & other) {
-    return this->id == other.id;
+    return this->mat.id == other.mat.id && this->color == other.color;
 }
@@ -9,15 +9,37 @@
 
 #define INC_MaterialInstance
 
+// 16-bit handle to a registered Material that can be used like a Material*
+class MaterialRef {
+public:
+    uint16_t id;
+
+    MaterialRef(Material* mat) : id((uint16_t)mat->id) {};
+
+    MaterialRef& operator=(Material* mat) {
+        id = (uint16_t)mat->id;
+        return *this;
+    }
+
+    Material* operator->() const {
+        return Materials::MATERIALS_ARRAY[id];
+    }
+
+    operator Material*() const {
+        return Materials::MATERIALS_ARRAY[id];
+    }
+};
+
+// one cell of the world, kept at 8 bytes so the tile arrays stay cache friendly
+// the layout is also the on-disk layout of chunk files (see MaterialInstanceData)
 class MaterialInstance {
-    static int _curID;
 public:
-    Material* mat;
+    MaterialRef mat;
+    int16_t temperature;
     Uint32 color;
-    int32_t temperature;
-    uint32_t id = 0;
     MaterialInstance(Material* mat, Uint32 color, int32_t temperature);
     MaterialInstance(Material* mat, Uint32 color) : MaterialInstance(mat, color, 0) {};
     MaterialInstance() : MaterialInstance(&Materials::GENERIC_AIR, 0x000000, 0) {};
+    // same material and color, cells have no identity of their own (see RigidBody::stamped)
     bool operator==(const MaterialInstance& other);
 };
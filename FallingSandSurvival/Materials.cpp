@@ -1,5 +1,8 @@
 
 #include "Materials.h"
+#include "Tiles.h"
+#include <algorithm>
+#include <cstring>
 
 int Materials::nMaterials = 0;
 Material Materials::GENERIC_AIR        = Material(nMaterials++, "_AIR", PhysicsType::AIR, 255, 0, 0, 16, 0xffffff);
@@ -42,8 +45,32 @@ Material Materials::SOFT_DIRT_SAND     = Material(nMaterials++, "Soft Dirt Sand"
 
 Material Materials::FIRE               = Material(nMaterials++, "Fire", PhysicsType::PASSABLE, 255, 20, 1, 0, 0);
 
+// the MaterialInstances in Tiles store the material id, so they are defined here to be initialized after the materials
+const MaterialInstance Tiles::NOTHING       = MaterialInstance(&Materials::GENERIC_AIR   , 0x000000);
+const MaterialInstance Tiles::TEST_SOLID    = MaterialInstance(&Materials::GENERIC_SOLID , 0xff0000);
+const MaterialInstance Tiles::TEST_SAND     = MaterialInstance(&Materials::GENERIC_SAND  , 0xffff00);
+const MaterialInstance Tiles::TEST_LIQUID   = MaterialInstance(&Materials::GENERIC_LIQUID, 0x0000ff);
+const MaterialInstance Tiles::TEST_GAS      = MaterialInstance(&Materials::GENERIC_GAS   , 0x800080);
+const MaterialInstance Tiles::OBJECT		= MaterialInstance(&Materials::GENERIC_OBJECT, 0x00ff00);
+
 std::vector<Material*> Materials::MATERIALS;
 Material** Materials::MATERIALS_ARRAY;
+Uint8* Materials::PHYSICS_TYPE;
+Uint8* Materials::ITERATIONS;
+Uint8* Materials::ALPHA;
+float* Materials::DENSITY;
+Uint8* Materials::LIVE;
+float* Materials::CONDUCTION_SELF;
+float* Materials::CONDUCTION_OTHER;
+int32_t* Materials::ADD_TEMP;
+uint32_t* Materials::INTERACTION_START;
+MaterialInteraction* Materials::INTERACTIONS;
+uint64_t* Materials::HAS_INTERACTION;
+uint32_t* Materials::REACTION_START;
+int32_t* Materials::REACT_BELOW;
+int32_t* Materials::REACT_ABOVE;
+Uint8* Materials::THERMAL;
+MaterialInteraction* Materials::REACTIONS;
 void Materials::init() {
 
     Materials::GENERIC_AIR.conductionSelf = 0.8;
@@ -190,6 +217,73 @@ void Materials::init() {
 
     MATERIALS_ARRAY = MATERIALS.data();
 
+    PHYSICS_TYPE = new Uint8[MATERIALS.size()];
+    ITERATIONS = new Uint8[MATERIALS.size()];
+    ALPHA = new Uint8[MATERIALS.size()];
+    DENSITY = new float[MATERIALS.size()];
+    LIVE = new Uint8[MATERIALS.size()];
+    CONDUCTION_SELF = new float[MATERIALS.size()];
+    CONDUCTION_OTHER = new float[MATERIALS.size()];
+    ADD_TEMP = new int32_t[MATERIALS.size()];
+    for(int i = 0; i < MATERIALS.size(); i++) {
+        PHYSICS_TYPE[i] = MATERIALS[i]->physicsType;
+        ITERATIONS[i] = MATERIALS[i]->iterations;
+        ALPHA[i] = MATERIALS[i]->alpha;
+        DENSITY[i] = MATERIALS[i]->density;
+        int type = MATERIALS[i]->physicsType;
+        LIVE[i] = type == PhysicsType::SAND || type == PhysicsType::SOUP || type == PhysicsType::GAS || i == FIRE.id;
+        CONDUCTION_SELF[i] = MATERIALS[i]->conductionSelf;
+        CONDUCTION_OTHER[i] = MATERIALS[i]->conductionOther;
+        ADD_TEMP[i] = (int32_t)MATERIALS[i]->addTemp;
+    }
+
+    int n = (int)MATERIALS.size();
+    std::vector<MaterialInteraction> flat;
+
+    INTERACTION_START = new uint32_t[n * n + 1];
+    HAS_INTERACTION = new uint64_t[(n * n + 63) / 64];
+    memset(HAS_INTERACTION, 0, (n * n + 63) / 64 * sizeof(uint64_t));
+    for(int a = 0; a < n; a++) {
+        for(int b = 0; b < n; b++) {
+            int p = a * n + b;
+            INTERACTION_START[p] = (uint32_t)flat.size();
+            if(!MATERIALS[a]->interact) continue;
+            for(int i = 0; i < MATERIALS[a]->nInteractions[b]; i++) {
+                flat.push_back(MATERIALS[a]->interactions[b][i]);
+            }
+            if(flat.size() > INTERACTION_START[p]) HAS_INTERACTION[p >> 6] |= 1ULL << (p & 63);
+        }
+    }
+    INTERACTION_START[n * n] = (uint32_t)flat.size();
+    INTERACTIONS = new MaterialInteraction[flat.size() + 1];
+    std::copy(flat.begin(), flat.end(), INTERACTIONS);
+
+    flat.clear();
+    REACTION_START = new uint32_t[n + 1];
+    for(int a = 0; a < n; a++) {
+        REACTION_START[a] = (uint32_t)flat.size();
+        if(!MATERIALS[a]->react) continue;
+        for(int i = 0; i < MATERIALS[a]->nReactions; i++) {
+            flat.push_back(MATERIALS[a]->reactions[i]);
+        }
+    }
+    REACTION_START[n] = (uint32_t)flat.size();
+    REACTIONS = new MaterialInteraction[flat.size() + 1];
+    std::copy(flat.begin(), flat.end(), REACTIONS);
+
+    REACT_BELOW = new int32_t[n];
+    REACT_ABOVE = new int32_t[n];
+    THERMAL = new Uint8[n];
+    for(int a = 0; a < n; a++) {
+        REACT_BELOW[a] = INT32_MIN;
+        REACT_ABOVE[a] = INT32_MAX;
+        for(uint32_t i = REACTION_START[a]; i < REACTION_START[a + 1]; i++) {
+            if(REACTIONS[i].type == REACT_TEMPERATURE_BELOW) REACT_BELOW[a] = std::max(REACT_BELOW[a], REACTIONS[i].data1);
+            if(REACTIONS[i].type == REACT_TEMPERATURE_ABOVE) REACT_ABOVE[a] = std::min(REACT_ABOVE[a], REACTIONS[i].data1);
+        }
+        THERMAL[a] = ADD_TEMP[a] != 0 || REACTION_START[a] != REACTION_START[a + 1];
+    }
+
     #undef REGISTER
 
 }
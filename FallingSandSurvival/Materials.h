@@ -5,6 +5,7 @@
 #endif // !INC_Material
 
 #include <vector>
+#include <cstdint>
 
 #define INC_Materials
 
@@ -14,6 +15,39 @@ public:
     static std::vector<Material*> MATERIALS;
     static Material** MATERIALS_ARRAY;
 
+    // flat per-material properties indexed by Material::id, for the per-cell loops
+    static Uint8* PHYSICS_TYPE;
+    static Uint8* ITERATIONS;
+    static Uint8* ALPHA;
+    static float* DENSITY;
+    // 1 for materials World::tick can move or burn (sand, liquids, gases, fire)
+    static Uint8* LIVE;
+    // heat conduction, see Temperature
+    static float* CONDUCTION_SELF;
+    static float* CONDUCTION_OTHER;
+    static int32_t* ADD_TEMP;
+
+    // Material::interactions/reactions packed into flat arrays, also built at the end of init
+    // the interactions of material a touching b are INTERACTIONS[INTERACTION_START[p]] up to INTERACTIONS[INTERACTION_START[p + 1]], with p = a * nMaterials + b
+    static uint32_t* INTERACTION_START;
+    static MaterialInteraction* INTERACTIONS;
+    // bit p is set if the pair has any interactions at all
+    static uint64_t* HAS_INTERACTION;
+    // the reactions of material a are REACTIONS[REACTION_START[a]] up to REACTIONS[REACTION_START[a + 1]]
+    static uint32_t* REACTION_START;
+    static MaterialInteraction* REACTIONS;
+    // a cell may react once its temperature drops below REACT_BELOW or rises above REACT_ABOVE
+    // INT32_MIN/INT32_MAX for materials without such reactions
+    static int32_t* REACT_BELOW;
+    static int32_t* REACT_ABOVE;
+    // 1 for materials World::tickTemperature has to look at even while they sit at 0: heat sources and anything with reactions
+    static Uint8* THERMAL;
+
+    static bool hasInteraction(int a, int b) {
+        int p = a * nMaterials + b;
+        return (HAS_INTERACTION[p >> 6] >> (p & 63)) & 1;
+    }
+
     static Material GENERIC_AIR;
     static Material GENERIC_SOLID;
     static Material GENERIC_SAND;
@@ -1,6 +1,5 @@
 
 #include "Particle.h"
-#include <iostream>
 
 Particle::Particle(MaterialInstance tile, float x, float y, float vx, float vy, float ax, float ay) {
     this->tile = tile;
@@ -12,12 +11,117 @@ Particle::Particle(MaterialInstance tile, float x, float y, float vx, float vy,
     this->ay = ay;
 }
 
-Particle::Particle(const Particle & part) {
-    tile = part.tile;
-    x = part.x;
-    y = part.y;
-    vx = part.vx;
-    vy = part.vy;
-    ax = part.ax;
-    ay = part.ay;
+int ParticleStore::add(const Particle& p) {
+    tile.push_back(p.tile);
+    x.push_back(p.x);
+    y.push_back(p.y);
+    vx.push_back(p.vx);
+    vy.push_back(p.vy);
+    ax.push_back(p.ax);
+    ay.push_back(p.ay);
+    targetX.push_back(p.targetX);
+    targetY.push_back(p.targetY);
+    targetForce.push_back(p.targetForce);
+    phase.push_back(p.phase);
+    temporary.push_back(p.temporary);
+    lifetime.push_back(p.lifetime);
+    fadeTime.push_back(p.fadeTime);
+    id.push_back(0);
+    return size() - 1;
+}
+
+void ParticleStore::remove(int slot) {
+    if(id[slot] != 0) {
+        idSlot[id[slot]] = -1;
+        killed.push_back(id[slot]);
+    }
+
+    int last = size() - 1;
+    if(slot != last) {
+        tile[slot] = tile[last];
+        x[slot] = x[last];
+        y[slot] = y[last];
+        vx[slot] = vx[last];
+        vy[slot] = vy[last];
+        ax[slot] = ax[last];
+        ay[slot] = ay[last];
+        targetX[slot] = targetX[last];
+        targetY[slot] = targetY[last];
+        targetForce[slot] = targetForce[last];
+        phase[slot] = phase[last];
+        temporary[slot] = temporary[last];
+        lifetime[slot] = lifetime[last];
+        fadeTime[slot] = fadeTime[last];
+        id[slot] = id[last];
+        if(id[slot] != 0) idSlot[id[slot]] = slot;
+    }
+
+    tile.pop_back();
+    x.pop_back();
+    y.pop_back();
+    vx.pop_back();
+    vy.pop_back();
+    ax.pop_back();
+    ay.pop_back();
+    targetX.pop_back();
+    targetY.pop_back();
+    targetForce.pop_back();
+    phase.pop_back();
+    temporary.pop_back();
+    lifetime.pop_back();
+    fadeTime.pop_back();
+    id.pop_back();
+}
+
+void ParticleStore::clear() {
+    for(int i = 0; i < size(); i++) {
+        if(id[i] != 0) killed.push_back(id[i]);
+    }
+
+    tile.clear();
+    x.clear();
+    y.clear();
+    vx.clear();
+    vy.clear();
+    ax.clear();
+    ay.clear();
+    targetX.clear();
+    targetY.clear();
+    targetForce.clear();
+    phase.clear();
+    temporary.clear();
+    lifetime.clear();
+    fadeTime.clear();
+    id.clear();
+    for(auto& s : idSlot) s = -1;
+}
+
+uint32_t ParticleStore::track(int slot) {
+    if(id[slot] != 0) return id[slot];
+
+    // id 0 means untracked
+    if(idSlot.empty()) idSlot.push_back(-1);
+
+    uint32_t newId;
+    if(!freeIds.empty()) {
+        newId = freeIds.back();
+        freeIds.pop_back();
+    } else {
+        newId = (uint32_t)idSlot.size();
+        idSlot.push_back(-1);
+    }
+
+    idSlot[newId] = slot;
+    id[slot] = newId;
+    return newId;
+}
+
+int ParticleStore::find(uint32_t id) {
+    if(id == 0 || id >= idSlot.size()) return -1;
+    return idSlot[id];
+}
+
+void ParticleStore::clearKilled() {
+    freeIds.insert(freeIds.end(), killed.begin(), killed.end());
+    killed.clear();
 }
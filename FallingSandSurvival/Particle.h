@@ -6,8 +6,9 @@
 #include "Tiles.h"
 #endif // !INC_Tiles
 
-#include <functional>
+#include <vector>
 
+// a particle to spawn, World::addParticle copies it into World::particles
 class Particle {
 public:
     MaterialInstance tile {};
@@ -24,7 +25,73 @@ public:
     bool temporary = false;
     int lifetime = 0;
     int fadeTime = 60;
-    std::function<void()> killCallback = []() {};
     Particle(MaterialInstance tile, float x, float y, float vx, float vy, float ax, float ay);
-    Particle(const Particle &part);
+};
+
+// what World::addParticle and World::tickParticles did to stay under Settings::particle_budget
+class ParticleStats {
+public:
+    // spawns that went straight into the tiles
+    int deposited = 0;
+    // temporary spawns thrown away
+    int dropped = 0;
+    // temporary particles removed for sharing a cell with one of the same material
+    int merged = 0;
+};
+
+// a particle that hit something and turns back into a tile
+// (lx, ly) is the cell it came from and (x, y) where it hit, see World::depositParticle
+class ParticleDeposit {
+public:
+    MaterialInstance tile;
+    int lx;
+    int ly;
+    float x;
+    float y;
+};
+
+// every live particle, one array per field so the per-tick loops stream through memory
+// fire and falling sand make and kill thousands of these a second, so slots are reused instead of allocating each particle
+// removing a particle moves the last one into its slot: anything that needs to find a particle again has to track() it
+class ParticleStore {
+    // slot of each tracked id, and ids free to hand out again
+    std::vector<int> idSlot;
+    std::vector<uint32_t> freeIds;
+
+public:
+    std::vector<MaterialInstance> tile;
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> vx;
+    std::vector<float> vy;
+    std::vector<float> ax;
+    std::vector<float> ay;
+    std::vector<float> targetX;
+    std::vector<float> targetY;
+    std::vector<float> targetForce;
+    std::vector<Uint8> phase;
+    std::vector<Uint8> temporary;
+    std::vector<int> lifetime;
+    std::vector<int> fadeTime;
+    // id of each slot, 0 if untracked
+    std::vector<uint32_t> id;
+
+    // ids of tracked particles removed since the last clearKilled
+    std::vector<uint32_t> killed;
+
+    int size() {
+        return (int)x.size();
+    }
+
+    // returns the slot of the new particle
+    int add(const Particle& p);
+    void remove(int slot);
+    void clear();
+
+    // gives the particle in the slot an id that stays valid until it dies and shows up in killed
+    uint32_t track(int slot);
+    // the slot of a tracked particle, -1 once it is gone
+    int find(uint32_t id);
+    // forgets killed, the ids in it may be handed out again after this
+    void clearKilled();
 };
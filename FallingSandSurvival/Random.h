@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+#define INC_Random
+
+// small seedable PCG32 generator
+// use this instead of rand() on worker threads: rand() shares one global state (and takes a lock on some platforms),
+// and with a fixed seed the same numbers come out every run
+class Random {
+    uint64_t state = 0;
+    uint64_t inc = 1;
+
+    static uint64_t mix(uint64_t v) {
+        // splitmix64 finalizer, spreads nearby seeds (neighbouring chunks, consecutive ticks) apart
+        v += 0x9E3779B97F4A7C15ULL;
+        v = (v ^ (v >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        v = (v ^ (v >> 27)) * 0x94D049BB133111EBULL;
+        return v ^ (v >> 31);
+    }
+
+public:
+    Random(uint64_t seed, uint64_t stream) {
+        inc = (stream << 1) | 1;
+        nextU32();
+        state += seed;
+        nextU32();
+    }
+
+    // a stream for one chunk at one point in time, so results don't depend on which thread runs the chunk
+    Random(uint32_t worldSeed, int32_t chunkX, int32_t chunkY, uint32_t tick)
+        : Random(mix(((uint64_t)worldSeed << 32) | tick), mix(((uint64_t)(uint32_t)chunkX << 32) | (uint32_t)chunkY)) {};
+
+    uint32_t nextU32() {
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + inc;
+        uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+        uint32_t rot = (uint32_t)(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+
+    // drop-in for rand(): a non-negative int
+    int next() {
+        return (int)(nextU32() >> 1);
+    }
+};
@@ -0,0 +1,284 @@
+
+#include "RegionFile.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path) {
+    // the region keeps writing to the file through its fstream while it's mapped
+    HANDLE f = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(f == INVALID_HANDLE_VALUE) return;
+    fileHandle = f;
+
+    LARGE_INTEGER fileSize;
+    if(!GetFileSizeEx(f, &fileSize) || fileSize.QuadPart == 0) return;
+
+    HANDLE m = CreateFileMappingA(f, NULL, PAGE_READONLY, 0, 0, NULL);
+    if(m == NULL) return;
+    mappingHandle = m;
+
+    void* view = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+    if(view == NULL) return;
+    data = (const char*)view;
+    size = (size_t)fileSize.QuadPart;
+}
+
+MappedFile::~MappedFile() {
+    if(data) UnmapViewOfFile(data);
+    if(mappingHandle) CloseHandle(mappingHandle);
+    if(fileHandle) CloseHandle(fileHandle);
+}
+
+void MappedFile::prefetch(size_t offset, size_t length) {
+#if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+    if(!data || offset >= size) return;
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = (PVOID)(data + offset);
+    range.NumberOfBytes = (std::min)(length, size - offset);
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0) return;
+
+    struct stat st;
+    if(fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* view = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if(view != MAP_FAILED) {
+            data = (const char*)view;
+            size = (size_t)st.st_size;
+        }
+    }
+
+    // the mapping stays valid without the descriptor
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if(data) munmap((void*)data, size);
+}
+
+void MappedFile::prefetch(size_t offset, size_t length) {
+    if(!data || offset >= size) return;
+    // madvise wants a page aligned address
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t start = offset / page * page;
+    size_t end = (std::min)(offset + length, size);
+    madvise((void*)(data + start), end - start, MADV_WILLNEED);
+}
+
+#endif
+
+RegionFile::RegionFile(std::string path) {
+    this->path = path;
+
+    file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+    if(!file.is_open()) {
+        // fstream only creates files when opened for writing alone
+        std::ofstream create(path, std::ios::binary);
+        create.close();
+        file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+    }
+    if(!file.is_open()) throw std::runtime_error("Failed to open region file " + path);
+
+    file.seekg(0, std::ios::end);
+    size_t fileSize = (size_t)file.tellg();
+    size_t fileSectors = (fileSize + REGION_SECTOR - 1) / REGION_SECTOR;
+
+    used.assign((std::max)(fileSectors, (size_t)TABLE_SECTORS), false);
+    for(int i = 0; i < TABLE_SECTORS; i++) used[i] = true;
+
+    if(fileSize < TABLE_SECTORS * REGION_SECTOR) {
+        // new file, write an empty table
+        file.seekp(0);
+        std::vector<char> zero(TABLE_SECTORS * REGION_SECTOR, 0);
+        file.write(zero.data(), zero.size());
+        file.flush();
+        return;
+    }
+
+    file.seekg(0);
+    file.read((char*)table, sizeof(table));
+    for(int i = 0; i < REGION_CHUNKS * REGION_CHUNKS; i++) {
+        Entry& e = table[i];
+        if(e.size == 0) continue;
+
+        // an entry pointing outside the file or into another chunk is dropped, the chunk will be generated again
+        bool ok = e.sector >= TABLE_SECTORS && e.sector + sectorsFor(e.size) <= fileSectors;
+        for(int s = 0; ok && s < sectorsFor(e.size); s++) ok = !used[e.sector + s];
+        if(!ok) {
+            e = Entry();
+            continue;
+        }
+        for(int s = 0; s < sectorsFor(e.size); s++) used[e.sector + s] = true;
+    }
+}
+
+void RegionFile::writeEntry(int i) {
+    file.seekp(i * sizeof(Entry));
+    file.write((char*)&table[i], sizeof(Entry));
+}
+
+bool RegionFile::has(int lx, int ly) {
+    std::lock_guard<std::mutex> lock(mtx);
+    return table[lx + ly * REGION_CHUNKS].size != 0;
+}
+
+MappedFile* RegionFile::getMapping(size_t end) {
+    // views of the old mapping keep it alive
+    if(!mapping || (mapping->data && mapping->size < end)) mapping = std::make_shared<MappedFile>(path);
+    return mapping.get();
+}
+
+void RegionFile::freeSectors(int sector, int count) {
+    if(views.empty()) {
+        for(int s = 0; s < count; s++) used[sector + s] = false;
+        return;
+    }
+    // views handed out from now on can't point into them anymore
+    retired.push_back({epoch++, sector, count});
+}
+
+void RegionFile::release(uint64_t epoch) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = views.find(epoch);
+    if(--it->second == 0) views.erase(it);
+
+    uint64_t oldest = views.empty() ? UINT64_MAX : views.begin()->first;
+    while(!retired.empty() && retired.front().epoch < oldest) {
+        Retired& r = retired.front();
+        for(int s = 0; s < r.count; s++) used[r.sector + s] = false;
+        retired.pop_front();
+    }
+}
+
+RegionView::~RegionView() {
+    if(region) region->release(epoch);
+}
+
+bool RegionFile::view(int lx, int ly, RegionView& out) {
+    std::lock_guard<std::mutex> lock(mtx);
+    Entry& e = table[lx + ly * REGION_CHUNKS];
+    if(e.size == 0) return false;
+
+    size_t offset = (size_t)e.sector * REGION_SECTOR;
+    MappedFile* m = getMapping(offset + e.size);
+    if(m->data && offset + e.size <= m->size) {
+        views[epoch]++;
+        out.region = this;
+        out.epoch = epoch;
+        out.file = mapping;
+        out.data = m->data + offset;
+        out.size = e.size;
+        return true;
+    }
+
+    // couldn't map it, read a copy instead
+    file.clear();
+    out.buffer.resize(e.size);
+    file.seekg((std::streamoff)offset);
+    file.read(out.buffer.data(), e.size);
+    if(!file) {
+        file.clear();
+        return false;
+    }
+    out.data = out.buffer.data();
+    out.size = e.size;
+    return true;
+}
+
+void RegionFile::prefetch(int lx, int ly) {
+    std::lock_guard<std::mutex> lock(mtx);
+    Entry& e = table[lx + ly * REGION_CHUNKS];
+    if(e.size == 0) return;
+    getMapping((size_t)e.sector * REGION_SECTOR + e.size)->prefetch((size_t)e.sector * REGION_SECTOR, e.size);
+}
+
+void RegionFile::write(int lx, int ly, const char* data, size_t size) {
+    std::lock_guard<std::mutex> lock(mtx);
+    int i = lx + ly * REGION_CHUNKS;
+    Entry& e = table[i];
+    int need = sectorsFor(size);
+
+    // never write over the saved copy, if the game dies before the table points to the new one the old one is still whole
+    // first run of free sectors that fits, or the end of the file
+    int start = TABLE_SECTORS;
+    int run = 0;
+    for(int s = TABLE_SECTORS; s < (int)used.size() && run < need; s++) {
+        if(used[s]) {
+            start = s + 1;
+            run = 0;
+        } else {
+            run++;
+        }
+    }
+    file.clear();
+    if(start + need > (int)used.size()) {
+        // grow the file with zeroed sectors, they count as free when it's opened again
+        int grown = (std::max)(start + need, (int)used.size() + REGION_GROW);
+        static const char zero[REGION_SECTOR] = {};
+        file.seekp((std::streamoff)used.size() * REGION_SECTOR);
+        for(int s = (int)used.size(); s < grown; s++) file.write(zero, REGION_SECTOR);
+        used.resize(grown, false);
+    }
+    for(int s = 0; s < need; s++) used[start + s] = true;
+
+    // pad to whole sectors
+    file.seekp((std::streamoff)start * REGION_SECTOR);
+    file.write(data, size);
+    size_t pad = (size_t)need * REGION_SECTOR - size;
+    if(pad > 0) {
+        static const char zero[REGION_SECTOR] = {};
+        file.write(zero, pad);
+    }
+    file.flush();
+
+    // only now point the table to it and give back the old sectors
+    int oldSector = e.sector;
+    int had = e.size == 0 ? 0 : sectorsFor(e.size);
+    e.sector = start;
+    e.size = (uint32_t)size;
+    writeEntry(i);
+    file.flush();
+    // a view may still be reading the old sectors, they're only reused once it's done
+    if(had > 0) freeSectors(oldSector, had);
+}
+
+void RegionFile::sync() {
+    std::lock_guard<std::mutex> lock(mtx);
+    file.flush();
+
+    // fstream can't sync, open the file again to do it
+#ifdef _WIN32
+    HANDLE f = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(f == INVALID_HANDLE_VALUE) return;
+    FlushFileBuffers(f);
+    CloseHandle(f);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0) return;
+    fsync(fd);
+    close(fd);
+#endif
+}
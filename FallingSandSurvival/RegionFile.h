@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define INC_RegionFile
+
+// chunks per region file along each axis
+#define REGION_CHUNKS 32
+// region files are allocated in sectors of this many bytes
+#define REGION_SECTOR 4096
+// region files grow by at least this many sectors, so the mapping doesn't have to be redone for every new chunk
+#define REGION_GROW 64
+
+// a whole file mapped read-only into memory
+class MappedFile {
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+
+public:
+    // nullptr if the file couldn't be mapped
+    const char* data = nullptr;
+    size_t size = 0;
+
+    MappedFile(const std::string& path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // tells the OS these bytes will be read soon so it can page them in ahead of time
+    void prefetch(size_t offset, size_t length);
+};
+
+class RegionFile;
+
+// the saved bytes of one chunk, see RegionFile::view
+// points into the mapped region file when it could be mapped, otherwise into buffer
+// sectors freed while a view into the mapping is alive aren't reused until it's done, so its bytes can't change under it
+class RegionView {
+public:
+    // keeps the mapping alive while the view is used
+    std::shared_ptr<MappedFile> file;
+    // the region the view points into, nullptr for a copy in buffer
+    RegionFile* region = nullptr;
+    // when the region handed the view out
+    uint64_t epoch = 0;
+    std::vector<char> buffer;
+    const char* data = nullptr;
+    size_t size = 0;
+
+    RegionView() {}
+    ~RegionView();
+    RegionView(const RegionView&) = delete;
+    RegionView& operator=(const RegionView&) = delete;
+};
+
+// REGION_CHUNKS * REGION_CHUNKS chunk files in one file
+// the first sectors hold a table with the first sector and byte size of each chunk, the chunks follow in whole sectors
+// a chunk is always written to the first free sectors that fit it, its old sectors are freed once the table points to the new ones
+// sectors are the size of a page, so a chunk read from the mapping touches only its own pages
+// safe to use from several threads
+class RegionFile {
+    class Entry {
+    public:
+        uint32_t sector = 0;
+        uint32_t size = 0;
+    };
+
+    std::string path;
+    std::fstream file;
+    std::mutex mtx;
+    Entry table[REGION_CHUNKS * REGION_CHUNKS];
+    // which sectors are taken, the table's included
+    std::vector<bool> used;
+    // the whole file, mapped again only when a chunk lies past its end
+    // it's shared with the file, so writes to sectors it covers show up in it
+    std::shared_ptr<MappedFile> mapping;
+    // counts sectors freed while views were alive, views and freed sectors are stamped with it
+    uint64_t epoch = 0;
+    // views into the mapping that are still alive, by epoch
+    std::map<uint64_t, int> views;
+    // freed sectors given back once every view from their epoch or before is done
+    class Retired {
+    public:
+        uint64_t epoch;
+        int sector;
+        int count;
+    };
+    std::deque<Retired> retired;
+
+    static int sectorsFor(size_t size) {
+        return (int)((size + REGION_SECTOR - 1) / REGION_SECTOR);
+    }
+    void writeEntry(int i);
+    // mtx has to be held for both
+    // the mapping, mapped again if it ends before end
+    MappedFile* getMapping(size_t end);
+    void freeSectors(int sector, int count);
+    // called by RegionView when it's done
+    void release(uint64_t epoch);
+    friend class RegionView;
+
+public:
+    // sectors taken by the table
+    static const int TABLE_SECTORS = (REGION_CHUNKS * REGION_CHUNKS * sizeof(Entry) + REGION_SECTOR - 1) / REGION_SECTOR;
+
+    // opens the file, creating it if there is none
+    RegionFile(std::string path);
+
+    // lx and ly are the chunk's position in the region, 0 to REGION_CHUNKS - 1
+    bool has(int lx, int ly);
+    // the chunk's bytes without copying them out of the file, returns false if the region doesn't have the chunk
+    bool view(int lx, int ly, RegionView& out);
+    // starts paging in the chunk's bytes, for chunks that are about to be read
+    void prefetch(int lx, int ly);
+    void write(int lx, int ly, const char* data, size_t size);
+    // returns once everything written so far is on the disk itself, not just in the OS's cache
+    void sync();
+
+    // region of a chunk coordinate, and the chunk's position in it
+    static int region(int c) {
+        return c >= 0 ? c / REGION_CHUNKS : -((-c - 1) / REGION_CHUNKS) - 1;
+    }
+    static int local(int c) {
+        return c - region(c) * REGION_CHUNKS;
+    }
+};
@@ -27,6 +27,9 @@ public:
     int matWidth = 0;
     int matHeight = 0;
     MaterialInstance* tiles = nullptr;
+    // where each of the tiles was put into the world last tick, relative to the load zone, or INT_MIN if it wasn't
+    // only those cells are taken back, other cells of the same material and color are left alone
+    std::vector<std::pair<int, int>> stamped;
 
     // hitbox needs update
     bool needsUpdate = false;
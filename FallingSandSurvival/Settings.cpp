@@ -13,6 +13,8 @@ bool Settings::draw_uinode_bounds   = false;
 bool Settings::draw_light_map       = false;
 bool Settings::draw_temperature_map = false;
 bool Settings::draw_shaders		    = false;
+bool Settings::draw_particle_stats  = false;
 bool Settings::tick_world           = true;
 bool Settings::tick_box2d           = false;
 bool Settings::tick_temperature     = true;
+int Settings::particle_budget       = 20000;
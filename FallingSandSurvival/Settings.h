@@ -14,7 +14,10 @@ public:
     static bool draw_light_map;
     static bool draw_temperature_map;
     static bool draw_shaders;
+    static bool draw_particle_stats;
     static bool tick_world;
     static bool tick_box2d;
     static bool tick_temperature;
+    // past half of this temporary particles live shorter and merge, past all of it new particles become tiles right away
+    static int particle_budget;
 };
@@ -0,0 +1,38 @@
+
+#include "SpatialGrid.h"
+
+void SpatialGrid::resize(int width, int height) {
+    binsW = (width + SPATIAL_BIN - 1) / SPATIAL_BIN;
+    binsH = (height + SPATIAL_BIN - 1) / SPATIAL_BIN;
+    clear();
+}
+
+void SpatialGrid::clear() {
+    entries.clear();
+    items.clear();
+    start.assign(binsW * binsH + 1, 0);
+}
+
+void SpatialGrid::add(int item, int minX, int minY, int maxX, int maxY) {
+    entries.push_back({item, binX(minX), binY(minY), binX(maxX), binY(maxY)});
+}
+
+void SpatialGrid::build() {
+    // counting sort: size every bin, then drop the items into place
+    start.assign(binsW * binsH + 1, 0);
+    for(Entry& e : entries) {
+        for(int by = e.minY; by <= e.maxY; by++) {
+            for(int bx = e.minX; bx <= e.maxX; bx++) start[bx + by * binsW + 1]++;
+        }
+    }
+    for(int i = 0; i < binsW * binsH; i++) start[i + 1] += start[i];
+
+    items.resize(start[binsW * binsH]);
+    std::vector<int> fill(start.begin(), start.end() - 1);
+    for(Entry& e : entries) {
+        for(int by = e.minY; by <= e.maxY; by++) {
+            for(int bx = e.minX; bx <= e.maxX; bx++) items[fill[bx + by * binsW]++] = e.item;
+        }
+    }
+    entries.clear();
+}
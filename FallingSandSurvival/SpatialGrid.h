@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+
+#define INC_SpatialGrid
+
+// side of a SpatialGrid bin in cells
+#define SPATIAL_BIN 16
+
+// item indices bucketed into a uniform grid of SPATIAL_BIN squares over the world
+// built from scratch in one go: add every item's box, then build()
+// boxes are clamped to the grid, so things past the edge land in the edge bins and are still found there
+class SpatialGrid {
+    class Entry {
+    public:
+        int item;
+        int minX;
+        int minY;
+        int maxX;
+        int maxY;
+    };
+
+    int binsW = 0;
+    int binsH = 0;
+    std::vector<Entry> entries;
+    // items of bin i are items[start[i]] to items[start[i + 1] - 1]
+    std::vector<int> start;
+    std::vector<int> items;
+
+    int binX(int x) {
+        return x < 0 ? 0 : (x / SPATIAL_BIN >= binsW ? binsW - 1 : x / SPATIAL_BIN);
+    }
+    int binY(int y) {
+        return y < 0 ? 0 : (y / SPATIAL_BIN >= binsH ? binsH - 1 : y / SPATIAL_BIN);
+    }
+
+public:
+    void resize(int width, int height);
+    void clear();
+    // the box is in cells, inclusive
+    void add(int item, int minX, int minY, int maxX, int maxY);
+    void build();
+
+    // calls f(item) for every item in a bin the box touches
+    // items whose box spans several bins may come up more than once
+    template<typename F> void query(int minX, int minY, int maxX, int maxY, F f) {
+        if(items.empty()) return;
+        int bx1 = binX(maxX);
+        int by1 = binY(maxY);
+        for(int by = binY(minY); by <= by1; by++) {
+            for(int bx = binX(minX); bx <= bx1; bx++) {
+                int b = bx + by * binsW;
+                for(int i = start[b]; i < start[b + 1]; i++) f(items[i]);
+            }
+        }
+    }
+};
@@ -0,0 +1,154 @@
+
+#include "TaskScheduler.h"
+
+#define BUILD_WITH_EASY_PROFILER
+#include <easy/profiler.h>
+#include "ProfilerConfig.h"
+
+TaskScheduler::TaskScheduler(int nThreads) {
+    if(nThreads <= 0) nThreads = (int)std::thread::hardware_concurrency();
+    if(nThreads <= 0) nThreads = 4;
+
+    nQueues = nThreads;
+    queues.reset(new WorkQueue[nQueues]);
+
+    for(int i = 1; i < nQueues; i++) {
+        threads.push_back(std::thread(&TaskScheduler::workerLoop, this, i));
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cv.notify_all();
+    for(auto& t : threads) t.join();
+}
+
+int TaskScheduler::addTask(std::function<void(int)> fn) {
+    tasks.push_back(fn);
+    dependents.push_back({});
+    nDependencies.push_back(0);
+    return (int)tasks.size() - 1;
+}
+
+void TaskScheduler::addDependency(int before, int after) {
+    dependents[before].push_back(after);
+    nDependencies[after]++;
+}
+
+void TaskScheduler::run() {
+    int n = (int)tasks.size();
+    if(n == 0) return;
+
+    pending.reset(new std::atomic<int>[n]);
+    for(int i = 0; i < n; i++) pending[i].store(nDependencies[i], std::memory_order_relaxed);
+    remaining.store(n, std::memory_order_release);
+
+    // deal the tasks that are ready right away out round robin
+    int q = 0;
+    for(int i = 0; i < n; i++) {
+        if(nDependencies[i] != 0) continue;
+        std::lock_guard<std::mutex> lock(queues[q].mtx);
+        queues[q].tasks.push_back(i);
+        q = (q + 1) % nQueues;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        generation++;
+    }
+    cv.notify_all();
+
+    work(0);
+
+    tasks.clear();
+    dependents.clear();
+    nDependencies.clear();
+}
+
+void TaskScheduler::workerLoop(int worker) {
+    EASY_THREAD("Task worker");
+    uint64_t seen = 0;
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [&] { return stopping || generation != seen; });
+            if(stopping) return;
+            seen = generation;
+        }
+        work(worker);
+    }
+}
+
+void TaskScheduler::work(int worker) {
+    int spins = 0;
+    while(remaining.load(std::memory_order_acquire) > 0) {
+        uint64_t seen = readyVersion.load();
+        int task;
+        if(pop(worker, &task) || steal(worker, &task)) {
+            execute(worker, task);
+            spins = 0;
+        } else if(spins < 64) {
+            // the next task is usually only a moment away
+            spins++;
+            std::this_thread::yield();
+        } else {
+            // sleep instead of taking cores from the other pools until something is ready
+            sleeping.fetch_add(1);
+            {
+                std::unique_lock<std::mutex> lock(readyMtx);
+                readyCv.wait(lock, [&] { return readyVersion.load() != seen || remaining.load(std::memory_order_acquire) == 0; });
+            }
+            sleeping.fetch_sub(1);
+            spins = 0;
+        }
+    }
+}
+
+void TaskScheduler::wakeIdle() {
+    readyVersion.fetch_add(1);
+    if(sleeping.load() == 0) return;
+    {
+        std::lock_guard<std::mutex> lock(readyMtx);
+    }
+    readyCv.notify_all();
+}
+
+bool TaskScheduler::pop(int worker, int* task) {
+    WorkQueue& q = queues[worker];
+    std::lock_guard<std::mutex> lock(q.mtx);
+    if(q.tasks.empty()) return false;
+    *task = q.tasks.back();
+    q.tasks.pop_back();
+    return true;
+}
+
+bool TaskScheduler::steal(int worker, int* task) {
+    for(int i = 1; i < nQueues; i++) {
+        WorkQueue& q = queues[(worker + i) % nQueues];
+        std::lock_guard<std::mutex> lock(q.mtx);
+        if(q.tasks.empty()) continue;
+        *task = q.tasks.front();
+        q.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void TaskScheduler::execute(int worker, int task) {
+    tasks[task](worker);
+
+    // whatever this unblocked goes on our own queue, it likely touches the same memory
+    bool unblocked = false;
+    for(int next : dependents[task]) {
+        if(pending[next].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(queues[worker].mtx);
+            queues[worker].tasks.push_back(next);
+            unblocked = true;
+        }
+    }
+
+    if(remaining.fetch_sub(1, std::memory_order_acq_rel) == 1 || unblocked) wakeIdle();
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define INC_TaskScheduler
+
+// runs a graph of small tasks on a work-stealing pool
+// a task becomes ready once every task it depends on has finished, so there is no barrier between "phases"
+// each worker pops its own queue from the back and steals from the front of the others'
+class TaskScheduler {
+    class WorkQueue {
+    public:
+        std::mutex mtx;
+        std::deque<int> tasks;
+    };
+
+    std::vector<std::thread> threads;
+    // queue 0 belongs to the thread calling run()
+    std::unique_ptr<WorkQueue[]> queues;
+    int nQueues = 0;
+
+    std::vector<std::function<void(int)>> tasks;
+    std::vector<std::vector<int>> dependents;
+    std::vector<int> nDependencies;
+    std::unique_ptr<std::atomic<int>[]> pending;
+    std::atomic<int> remaining {0};
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    uint64_t generation = 0;
+    bool stopping = false;
+
+    // bumped whenever tasks become ready or the run is done, idle workers sleep on it
+    std::atomic<uint64_t> readyVersion {0};
+    std::atomic<int> sleeping {0};
+    std::mutex readyMtx;
+    std::condition_variable readyCv;
+
+    void workerLoop(int worker);
+    void work(int worker);
+    bool pop(int worker, int* task);
+    bool steal(int worker, int* task);
+    void execute(int worker, int task);
+    void wakeIdle();
+
+public:
+    // nThreads <= 0 picks one per hardware thread, with the caller of run() counting as one of them
+    TaskScheduler(int nThreads = 0);
+    ~TaskScheduler();
+
+    // fn gets the index of the worker running it, 0 <= worker < size()
+    int addTask(std::function<void(int)> fn);
+    // `after` won't start until `before` has finished
+    void addDependency(int before, int after);
+    // runs every task added since the last run and waits for all of them, the caller helps out
+    void run();
+
+    int size() { return nQueues; }
+};
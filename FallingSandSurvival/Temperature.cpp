@@ -0,0 +1,174 @@
+
+#include "Temperature.h"
+
+#include <cstdlib>
+
+#if TEMPERATURE_SIMD
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// msvc lets any function use avx2 intrinsics, gcc and clang have to be told
+#if TEMPERATURE_SIMD && (defined(__GNUC__) || defined(__clang__))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+static inline int32_t diffuseCell(const int16_t* temp, const float* conduction, int stride, float conductionSelf, int32_t addTemp) {
+    float n = 0.01f;
+    float v = 0;
+    // neighbours column by column, the float sums have to be added up in the same order everywhere
+    // a cell at 0 adds exactly +0 to both sums, so it doesn't need to be skipped
+    for(int xx = -1; xx <= 1; xx++) {
+        for(int yy = -1; yy <= 1; yy++) {
+            int o = xx + yy * stride;
+            int t = temp[o];
+            float factor = (float)(abs(t) / 64) * conduction[o];
+            v += (float)t * factor;
+            n += factor;
+        }
+    }
+
+    if(v != 0) {
+        return (int32_t)((float)addTemp + v / n * conductionSelf + (float)temp[0] * (1 - conductionSelf));
+    }
+    return addTemp + temp[0];
+}
+
+void Temperature::diffuseRowScalar(const int16_t* temp, const float* conduction, int stride, const float* conductionSelf, const int32_t* addTemp, int32_t* out, int n) {
+    for(int i = 0; i < n; i++) {
+        out[i] = diffuseCell(temp + i, conduction + i, stride, conductionSelf[i], addTemp[i]);
+    }
+}
+
+#if TEMPERATURE_SIMD
+
+void Temperature::diffuseRowSSE2(const int16_t* temp, const float* conduction, int stride, const float* conductionSelf, const int32_t* addTemp, int32_t* out, int n) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    int i = 0;
+    for(; i + 4 <= n; i += 4) {
+        __m128 v = zero;
+        __m128 sum = _mm_set1_ps(0.01f);
+        __m128i center = _mm_setzero_si128();
+        for(int xx = -1; xx <= 1; xx++) {
+            for(int yy = -1; yy <= 1; yy++) {
+                int o = i + xx + yy * stride;
+                // sign extend 4 temperatures to 32 bit
+                __m128i t = _mm_loadl_epi64((const __m128i*)(temp + o));
+                t = _mm_srai_epi32(_mm_unpacklo_epi16(t, t), 16);
+                if(xx == 0 && yy == 0) center = t;
+
+                __m128i sign = _mm_srai_epi32(t, 31);
+                __m128i a = _mm_srli_epi32(_mm_sub_epi32(_mm_xor_si128(t, sign), sign), 6);
+                __m128 factor = _mm_mul_ps(_mm_cvtepi32_ps(a), _mm_loadu_ps(conduction + o));
+                v = _mm_add_ps(v, _mm_mul_ps(_mm_cvtepi32_ps(t), factor));
+                sum = _mm_add_ps(sum, factor);
+            }
+        }
+
+        __m128 self = _mm_loadu_ps(conductionSelf + i);
+        __m128i add = _mm_loadu_si128((const __m128i*)(addTemp + i));
+        __m128 r = _mm_add_ps(_mm_add_ps(_mm_cvtepi32_ps(add), _mm_mul_ps(_mm_div_ps(v, sum), self)), _mm_mul_ps(_mm_cvtepi32_ps(center), _mm_sub_ps(one, self)));
+
+        __m128i moved = _mm_castps_si128(_mm_cmpneq_ps(v, zero));
+        __m128i res = _mm_or_si128(_mm_and_si128(moved, _mm_cvttps_epi32(r)), _mm_andnot_si128(moved, _mm_add_epi32(add, center)));
+        _mm_storeu_si128((__m128i*)(out + i), res);
+    }
+
+    for(; i < n; i++) {
+        out[i] = diffuseCell(temp + i, conduction + i, stride, conductionSelf[i], addTemp[i]);
+    }
+}
+
+TARGET_AVX2 void Temperature::diffuseRowAVX2(const int16_t* temp, const float* conduction, int stride, const float* conductionSelf, const int32_t* addTemp, int32_t* out, int n) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    int i = 0;
+    for(; i + 8 <= n; i += 8) {
+        __m256 v = zero;
+        __m256 sum = _mm256_set1_ps(0.01f);
+        __m256i center = _mm256_setzero_si256();
+        for(int xx = -1; xx <= 1; xx++) {
+            for(int yy = -1; yy <= 1; yy++) {
+                int o = i + xx + yy * stride;
+                __m256i t = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(temp + o)));
+                if(xx == 0 && yy == 0) center = t;
+
+                __m256i a = _mm256_srli_epi32(_mm256_abs_epi32(t), 6);
+                __m256 factor = _mm256_mul_ps(_mm256_cvtepi32_ps(a), _mm256_loadu_ps(conduction + o));
+                v = _mm256_add_ps(v, _mm256_mul_ps(_mm256_cvtepi32_ps(t), factor));
+                sum = _mm256_add_ps(sum, factor);
+            }
+        }
+
+        __m256 self = _mm256_loadu_ps(conductionSelf + i);
+        __m256i add = _mm256_loadu_si256((const __m256i*)(addTemp + i));
+        __m256 r = _mm256_add_ps(_mm256_add_ps(_mm256_cvtepi32_ps(add), _mm256_mul_ps(_mm256_div_ps(v, sum), self)), _mm256_mul_ps(_mm256_cvtepi32_ps(center), _mm256_sub_ps(one, self)));
+
+        __m256 moved = _mm256_cmp_ps(v, zero, _CMP_NEQ_UQ);
+        __m256i res = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(_mm256_add_epi32(add, center)), _mm256_castsi256_ps(_mm256_cvttps_epi32(r)), moved));
+        _mm256_storeu_si256((__m256i*)(out + i), res);
+    }
+
+    for(; i < n; i++) {
+        out[i] = diffuseCell(temp + i, conduction + i, stride, conductionSelf[i], addTemp[i]);
+    }
+}
+
+bool Temperature::hasAVX2() {
+    #ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if(info[0] < 7) return false;
+
+    // the cpu needs avx, and the os has to save the ymm registers
+    __cpuid(info, 1);
+    if(!(info[2] & (1 << 27)) || !(info[2] & (1 << 28))) return false;
+    if((_xgetbv(0) & 6) != 6) return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+    #else
+    return __builtin_cpu_supports("avx2");
+    #endif
+}
+
+#endif
+
+void Temperature::findReactions(const int32_t* temp, const int32_t* below, const int32_t* above, int n, int first, std::vector<int>& out) {
+    int i = 0;
+    #if TEMPERATURE_SIMD
+    // hardly any cell reacts, so test 4 at a time and only look closer at the hits
+    for(; i + 4 <= n; i += 4) {
+        __m128i t = _mm_loadu_si128((const __m128i*)(temp + i));
+        __m128i lo = _mm_cmplt_epi32(t, _mm_loadu_si128((const __m128i*)(below + i)));
+        __m128i hi = _mm_cmpgt_epi32(t, _mm_loadu_si128((const __m128i*)(above + i)));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(lo, hi)));
+        for(int j = 0; mask; j++, mask >>= 1) {
+            if(mask & 1) out.push_back(first + i + j);
+        }
+    }
+    #endif
+    for(; i < n; i++) {
+        if(temp[i] < below[i] || temp[i] > above[i]) out.push_back(first + i);
+    }
+}
+
+void Temperature::diffuseRow(const int16_t* temp, const float* conduction, int stride, const float* conductionSelf, const int32_t* addTemp, int32_t* out, int n) {
+    #if TEMPERATURE_SIMD
+    static const bool avx2 = hasAVX2();
+    if(avx2) {
+        diffuseRowAVX2(temp, conduction, stride, conductionSelf, addTemp, out, n);
+    } else {
+        diffuseRowSSE2(temp, conduction, stride, conductionSelf, addTemp, out, n);
+    }
+    #else
+    diffuseRowScalar(temp, conduction, stride, conductionSelf, addTemp, out, n);
+    #endif
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#define INC_Temperature
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define TEMPERATURE_SIMD 1
+#else
+#define TEMPERATURE_SIMD 0
+#endif
+
+// the heat diffusion stencil of World::tickTemperature
+// works on planes gathered out of the tiles: temperatures, and the conductionOther of each cell
+class Temperature {
+public:
+    // diffuses n cells of one row into out
+    // temp and conduction point at the first cell of the row, the rows above and below are `stride` away,
+    // and one cell to either side of the row has to be readable too
+    // conductionSelf and addTemp hold the properties of the row's own n cells
+    static void diffuseRow(const int16_t* temp, const float* conduction, int stride, const float* conductionSelf, const int32_t* addTemp, int32_t* out, int n);
+
+    // the reference, the SIMD versions give bit-identical results
+    static void diffuseRowScalar(const int16_t* temp, const float* conduction, int stride, const float* conductionSelf, const int32_t* addTemp, int32_t* out, int n);
+#if TEMPERATURE_SIMD
+    static void diffuseRowSSE2(const int16_t* temp, const float* conduction, int stride, const float* conductionSelf, const int32_t* addTemp, int32_t* out, int n);
+    static void diffuseRowAVX2(const int16_t* temp, const float* conduction, int stride, const float* conductionSelf, const int32_t* addTemp, int32_t* out, int n);
+    static bool hasAVX2();
+#endif
+
+    // appends first + i for each of the n cells with temp[i] < below[i] or temp[i] > above[i]
+    static void findReactions(const int32_t* temp, const int32_t* below, const int32_t* above, int n, int first, std::vector<int>& out);
+};
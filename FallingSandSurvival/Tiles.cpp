@@ -4,12 +4,7 @@
 
 #include "Macros.h"
 
-const MaterialInstance Tiles::NOTHING       = MaterialInstance(&Materials::GENERIC_AIR   , 0x000000);
-const MaterialInstance Tiles::TEST_SOLID    = MaterialInstance(&Materials::GENERIC_SOLID , 0xff0000);
-const MaterialInstance Tiles::TEST_SAND     = MaterialInstance(&Materials::GENERIC_SAND  , 0xffff00);
-const MaterialInstance Tiles::TEST_LIQUID   = MaterialInstance(&Materials::GENERIC_LIQUID, 0x0000ff);
-const MaterialInstance Tiles::TEST_GAS      = MaterialInstance(&Materials::GENERIC_GAS   , 0x800080);
-const MaterialInstance Tiles::OBJECT		= MaterialInstance(&Materials::GENERIC_OBJECT, 0x00ff00);
+// Tiles::NOTHING etc. are defined in Materials.cpp
 
 MaterialInstance Tiles::createTestSand() {
     Uint32 rgb = 220;
@@ -15,7 +15,12 @@
 #include "lib/cpp-marching-squares-master/MarchingSquares.h"
 #include "lib/polypartition-master/src/polypartition.h"
 #include "UTime.h"
+#include "Temperature.h"
+#include "Settings.h"
 #include <thread>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 #include "Populators.cpp"
 #include "DefaultGenerator.cpp"
 #include "MaterialTestGenerator.cpp"
@@ -40,15 +45,34 @@ void World::init(char* worldPath, uint16_t w, uint16_t h, GPU_Target* target, CA
     this->worldName = worldPath;
     EASY_BLOCK("makedir");
     experimental::filesystem::create_directories(worldPath);
+    experimental::filesystem::create_directories(std::string(worldPath) + "/regions");
     EASY_END_BLOCK;
 
+    EASY_BLOCK("find old chunk files");
+    // so chunks that were never saved don't each have to look for a file
+    std::string chunksDir = std::string(worldPath) + "/chunks";
+    if(experimental::filesystem::is_directory(chunksDir)) {
+        for(auto& p : experimental::filesystem::directory_iterator(chunksDir)) {
+            int cx, cy;
+            char end;
+            if(sscanf(p.path().filename().generic_string().c_str(), "chunk_%d_%d.tx%c", &cx, &cy, &end) == 3 && end == 't') {
+                ownFileChunks.insert((uint64_t)(uint32_t)cx << 32 | (uint32_t)cy);
+            }
+        }
+    }
+    EASY_END_BLOCK;
+
+    chunkWriter = new ChunkWriter();
+    // leave a core each for the main thread and the cell simulation
+    chunkLoader = new ChunkLoader(this, std::max(1, (int)std::thread::hardware_concurrency() - 2));
+
     metadata = WorldMeta::loadWorldMeta(this->worldName);
 
     width = w;
     height = h;
 
-    EASY_BLOCK("make tickPool");
-    tickPool = new ctpl::thread_pool(6);
+    EASY_BLOCK("make tickScheduler");
+    tickScheduler = new TaskScheduler();
     EASY_END_BLOCK;
 
     if(netMode != NetworkMode::SERVER) {
@@ -60,6 +84,12 @@ void World::init(char* worldPath, uint16_t w, uint16_t h, GPU_Target* target, CA
 
     EASY_BLOCK("create newTemps and light arrays");
     newTemps = new int32_t[width * height];
+    tempPlane = new int16_t[width * height];
+    conductionPlane = new float[width * height];
+    conductionSelfPlane = new float[width * height];
+    addTempPlane = new int32_t[width * height];
+    reactBelowPlane = new int32_t[width * height];
+    reactAbovePlane = new int32_t[width * height];
     light = new float[width * height];
     EASY_END_BLOCK;
 
@@ -85,7 +115,8 @@ void World::init(char* worldPath, uint16_t w, uint16_t h, GPU_Target* target, CA
     loadZone = {0, 0, w, h};
 
     EASY_BLOCK("init noise");
-    noise.SetSeed((unsigned int)Time::millis());
+    seed = (uint32_t)Time::millis();
+    noise.SetSeed(seed);
     noise.SetNoiseType(FastNoise::Perlin);
 
     noiseSIMD = FastNoiseSIMD::NewFastNoiseSIMD();
@@ -119,24 +150,35 @@ tooClose: {}
 
     rigidBodies.reserve(1);
 
-    EASY_BLOCK("init dirty/active/visited arrays");
+    EASY_BLOCK("init dirty/visited arrays");
     dirty = new bool[width * height];
     layer2Dirty = new bool[width * height];
     backgroundDirty = new bool[width * height];
-    lastActive = new bool[width * height];
-    active = new bool[width * height];
-    this->tickVisited = new bool[width * height];
+    this->tickVisited = new uint16_t[width * height];
+    memset(tickVisited, 0, width * height * sizeof(uint16_t));
+    particleGrid.resize(width, height);
+    rigidBodyGrid.resize(width, height);
+    depositAirW = (width + DEPOSIT_BLOCK - 1) / DEPOSIT_BLOCK;
+    depositAir = new Uint8[depositAirW * ((height + DEPOSIT_BLOCK - 1) / DEPOSIT_BLOCK)];
+    memset(depositAir, 0, depositAirW * ((height + DEPOSIT_BLOCK - 1) / DEPOSIT_BLOCK));
     for(int x = 0; x < width; x++) {
         for(int y = 0; y < height; y++) {
             dirty[x + y * width] = false;
             layer2Dirty[x + y * width] = false;
-            lastActive[x + y * width] = true;
-            active[x + y * width] = false;
             backgroundDirty[x + y * width] = false;
         }
     }
     EASY_END_BLOCK;
 
+    EASY_BLOCK("init simTiles");
+    simTilesW = width / SIM_TILE_W;
+    simTilesH = height / SIM_TILE_H;
+    simTiles = new SimTile[simTilesW * simTilesH];
+    liveCellsStride = (width + 63) / 64;
+    liveCells = new uint64_t[liveCellsStride * height];
+    memset(liveCells, 0, liveCellsStride * height * sizeof(uint64_t));
+    EASY_END_BLOCK;
+
     EASY_BLOCK("init layer arrays");
     tiles = new MaterialInstance[w * h];
     layer2 = new MaterialInstance[w * h];
@@ -146,7 +188,7 @@ tooClose: {}
             setTile(x, y, Tiles::NOTHING);
             layer2[x + y * width] = Tiles::NOTHING;
             background[x + y * width] = 0x00000000;
-            //particles.push_back(new Particle(x, y, 0, 0, 0, 0.1, 0xffff00));
+            //particles.add(Particle(x, y, 0, 0, 0, 0.1, 0xffff00));
         }
     }
     EASY_END_BLOCK;
@@ -1242,6 +1284,8 @@ void World::setTile(int x, int y, MaterialInstance type) {
     if(x < 0 || x >= width || y < 0 || y >= height) return;
     tiles[x + y * width] = type;
     dirty[x + y * width] = true;
+    updateLiveCell(x, y);
+    wake(x, y);
 }
 
 MaterialInstance World::getTileLayer2(int x, int y) {
@@ -1255,1074 +1299,636 @@ void World::setTileLayer2(int x, int y, MaterialInstance type) {
     layer2Dirty[x + y * width] = true;
 }
 
-void World::tick() {
-    EASY_FUNCTION(WORLD_PROFILER_COLOR);
+void World::markDirty(int index) {
+    dirty[index] = true;
+    updateLiveCell(index % width, index / width);
+    wake(index % width, index / width);
+}
 
-    tickChunks();
+void World::updateLiveCell(int x, int y) {
+    uint64_t bit = 1ULL << (x & 63);
+    uint64_t& word = liveCells[(x >> 6) + y * liveCellsStride];
+    if(Materials::LIVE[tiles[x + y * width].mat.id]) {
+        word |= bit;
+    } else {
+        word &= ~bit;
+    }
+}
 
-    // TODO: what if we only check tiles that were marked as dirty last tick?
+void World::refreshLiveCells(int minX, int minY, int maxX, int maxY) {
+    for(int y = minY; y <= maxY; y++) {
+        for(int x = minX; x <= maxX; x++) {
+            updateLiveCell(x, y);
+        }
+    }
+}
 
-    #define DO_MULTITHREADING
+void World::wake(int x, int y) {
+    // the neighbours of a changed cell may be able to move now too
+    wakeArea(x - 1, y - 1, x + 1, y + 1);
 
-    for(int iter = 0; iter < 4; iter++) {
-        EASY_BLOCK("iteration");
-        bool reverseX = (tickCt + iter) % 2 == 0;
-        for(int tk = 0; tk < 4; tk++) {
-            EASY_BLOCK("tk");
-            EASY_BLOCK("init");
-            int chOfsX = tk % 2;             // 0 1 0 1
-            int chOfsY = 1 - ((tk % 4) / 2); // 1 1 0 0
-
-            #ifdef DO_MULTITHREADING
-            std::vector<std::future<std::vector<Particle*>>> results = {};
-            #endif
-            EASY_BLOCK("memset");
-            memset(tickVisited, false, width * height);
-            EASY_END_BLOCK;
-            EASY_END_BLOCK;
-            EASY_BLOCK("loop");
-            for(int cx = tickZone.x + chOfsX * CHUNK_W; cx < (tickZone.x + tickZone.w); cx += CHUNK_W * 2) {
-                for(int cy = tickZone.y + chOfsY * CHUNK_H; cy < (tickZone.y + tickZone.h); cy += CHUNK_H * 2) {
-                    EASY_BLOCK("push_back");
-                    #ifdef DO_MULTITHREADING
-                    results.push_back(tickPool->push([&, cx, cy](int id) {
-                        EASY_THREAD("Chunk tick");
-                        EASY_BLOCK("setup");
-                        std::vector<Particle*> parts = {};
-                        EASY_END_BLOCK;
-                        #else
-                    EASY_THREAD("Chunk tick");
-                    #endif
-                    #define DO_REVERSE
-                    #ifdef DO_REVERSE
-                    if(reverseX) {
-                        EASY_BLOCK("chunk reverse");
-                        EASY_BLOCK("iter 1");
-                        for(int dy = CHUNK_H - 1; dy >= 0; dy--) {
-                            int y = cy + dy;
-                            for(int dx = CHUNK_W - 1; dx >= 0; dx--) {
-                                int x = cx + dx;
-                                int index = x + y * width;
-
-                                if(tickVisited[index]) continue;
-
-                                if(iter >= tiles[index].mat->iterations) {
-                                    tickVisited[index] = true;
-                                    continue;
-                                }
-                                MaterialInstance tile = tiles[index];
-                                Material* mat = tile.mat;
-                                int type = mat->physicsType;
-                                if(type == PhysicsType::AIR) continue;
-
-                                if(mat->id == Materials::FIRE.id) {
-                                    tickVisited[index] = true;
-
-                                    if(rand() % 10 == 0) {
-                                        Uint32 rgb = 255;
-                                        rgb = (rgb << 8) + 100 + rand() % 50;
-                                        rgb = (rgb << 8) + 50;
-                                        tile.color = rgb;
-                                    }
+    // and heat flows differently around it if it's hot, cold, a heat source or reacts to temperature
+    const MaterialInstance& tile = tiles[x + y * width];
+    if(tile.temperature != 0 || Materials::THERMAL[tile.mat.id]) heatArea(x - 1, y - 1, x + 1, y + 1);
+}
 
-                                    if(rand() % 10 == 0) {
-                                        Particle* p = new Particle(tile, x, y - 1, (rand() % 10 - 5) / 20.0f, -((rand() % 10) / 10.0f) / 3.0f + -0.5f, 0, 0.01f);
-                                        p->temporary = true;
-                                        p->lifetime = 30;
-                                        p->fadeTime = 10;
-                                        #ifdef DO_MULTITHREADING
-                                        parts.push_back(p);
-                                        #else
-                                        particles.push_back(p);
-                                        #endif
-                                    }
+// calls fn(tile, minX, minY, maxX, maxY) with the part of the area inside each sim tile it touches
+template<typename F>
+void World::forSimTiles(int minX, int minY, int maxX, int maxY, F fn) {
+    if(minX < 0) minX = 0;
+    if(minY < 0) minY = 0;
+    if(maxX >= width) maxX = width - 1;
+    if(maxY >= height) maxY = height - 1;
+    if(minX > maxX || minY > maxY) return;
 
-                                    if(rand() % 150 == 0) {
-                                        tiles[index] = Tiles::createSteam();
-                                        //tiles[index] = Tiles::NOTHING;
-                                        dirty[index] = true;
-                                    } else {
-                                        bool foundAny = false;
-                                        for(int xx = -2; xx <= 2; xx++) {
-                                            for(int yy = -2; yy <= 2; yy++) {
-                                                MaterialInstance fireSpread = tiles[(x + xx) + (y + yy) * width];
-                                                if(fireSpread.mat->physicsType == PhysicsType::SOLID && fireSpread.mat->id != Materials::FIRE.id) {
-                                                    foundAny = true;
-                                                    if(rand() % 500 == 0) {
-                                                        tiles[(x + xx) + (y + yy) * width] = Tiles::createFire();
-                                                        dirty[(x + xx) + (y + yy) * width] = true;
-                                                    }
-                                                }
-                                            }
-                                        }
-                                        if(!foundAny && rand() % 120 == 0) {
-                                            tiles[index] = Tiles::NOTHING;
-                                            dirty[index] = true;
-                                        }
-                                    }
-                                }
+    for(int ty = minY / SIM_TILE_H; ty <= maxY / SIM_TILE_H; ty++) {
+        for(int tx = minX / SIM_TILE_W; tx <= maxX / SIM_TILE_W; tx++) {
+            int x0 = std::max(minX, tx * SIM_TILE_W);
+            int y0 = std::max(minY, ty * SIM_TILE_H);
+            int x1 = std::min(maxX, tx * SIM_TILE_W + SIM_TILE_W - 1);
+            int y1 = std::min(maxY, ty * SIM_TILE_H + SIM_TILE_H - 1);
+            fn(simTiles[tx + ty * simTilesW], x0, y0, x1, y1);
+        }
+    }
+}
 
-                                if(type == PhysicsType::SAND) {
-                                    //active[index] = true;
-                                    MaterialInstance belowTile = tiles[x + (y + 1) * width];
-                                    int below = belowTile.mat->physicsType;
-
-                                    if(mat->interact && belowTile.mat->id >= 0 && belowTile.mat->id < Materials::nMaterials && mat->nInteractions[belowTile.mat->id] > 0) {
-                                        for(int i = 0; i < mat->nInteractions[belowTile.mat->id]; i++) {
-                                            MaterialInteraction in = mat->interactions[belowTile.mat->id][i];
-                                            if(in.type == INTERACT_TRANSFORM_MATERIAL) {
-                                                for(int xx = in.ofsX - in.data2; xx <= in.ofsX + in.data2; xx++) {
-                                                    for(int yy = in.ofsY - in.data2; yy <= in.ofsY + in.data2; yy++) {
-                                                        if(tiles[(x + xx) + (y + yy) * width].mat->id == belowTile.mat->id) {
-                                                            tiles[(x + xx) + (y + yy) * width] = Tiles::create(Materials::MATERIALS[in.data1], x + xx, y + yy);
-                                                            dirty[(x + xx) + (y + yy) * width] = true;
-                                                            tickVisited[(x + xx) + (y + yy) * width] = true;
-                                                        }
-                                                    }
-                                                }
-                                            } else if(in.type == INTERACT_SPAWN_MATERIAL) {
-                                                for(int xx = in.ofsX - in.data2; xx <= in.ofsX + in.data2; xx++) {
-                                                    for(int yy = in.ofsY - in.data2; yy <= in.ofsY + in.data2; yy++) {
-                                                        if((xx == 0 && yy == 0) || tiles[(x + xx) + (y + yy) * width].mat->id == Tiles::NOTHING.mat->id) {
-                                                            tiles[(x + xx) + (y + yy) * width] = Tiles::create(Materials::MATERIALS[in.data1], x + xx, y + yy);
-                                                            dirty[(x + xx) + (y + yy) * width] = true;
-                                                            tickVisited[(x + xx) + (y + yy) * width] = true;
-                                                        }
-                                                    }
-                                                }
-                                            }
-                                        }
-                                        continue;
-                                    }
+void World::wakeArea(int minX, int minY, int maxX, int maxY) {
+    forSimTiles(minX, minY, maxX, maxY, [](SimTile& t, int x0, int y0, int x1, int y1) {
+        t.wake.add(x0, y0, x1, y1);
+        if(t.warm) t.heatWake.add(x0, y0, x1, y1);
+    });
+}
 
-                                    if(mat->react && mat->nReactions > 0) {
-                                        bool react = false;
-                                        for(int i = 0; i < mat->nReactions; i++) {
-                                            MaterialInteraction in = mat->reactions[i];
-                                            if(in.type == REACT_TEMPERATURE_BELOW) {
-                                                if(tile.temperature < in.data1) {
-                                                    tiles[index] = Tiles::create(Materials::MATERIALS[in.data2], x, y);
-                                                    tiles[index].temperature = tile.temperature;
-                                                    dirty[index] = true;
-                                                    tickVisited[index] = true;
-                                                    react = true;
-                                                }
-                                            } else if(in.type == REACT_TEMPERATURE_ABOVE) {
-                                                if(tile.temperature > in.data1) {
-                                                    tiles[index] = Tiles::create(Materials::MATERIALS[in.data2], x, y);
-                                                    tiles[index].temperature = tile.temperature;
-                                                    dirty[index] = true;
-                                                    tickVisited[index] = true;
-                                                    react = true;
-                                                }
-                                            }
-                                        }
-                                        if(react) continue;
-                                    }
+void World::heatArea(int minX, int minY, int maxX, int maxY) {
+    forSimTiles(minX, minY, maxX, maxY, [](SimTile& t, int x0, int y0, int x1, int y1) {
+        t.heatWake.add(x0, y0, x1, y1);
+    });
+}
 
-                                    bool canMoveBelow = (below == PhysicsType::AIR || (below != PhysicsType::SOLID && belowTile.mat->density < mat->density));
-                                    if(!canMoveBelow) continue;
-
-                                    MaterialInstance belowLTile = tiles[(x - 1) + (y + 1) * width];
-                                    int belowL = belowLTile.mat->physicsType;
-                                    MaterialInstance belowRTile = tiles[(x + 1) + (y + 1) * width];
-                                    int belowR = belowRTile.mat->physicsType;
-
-                                    bool canMoveBelowL = (belowL == PhysicsType::AIR || (belowL != PhysicsType::SOLID && belowLTile.mat->density < mat->density));
-                                    bool canMoveBelowR = (belowR == PhysicsType::AIR || (belowR != PhysicsType::SOLID && belowRTile.mat->density < mat->density));
-
-                                    if(canMoveBelow && !((canMoveBelowL || canMoveBelowR) && rand() % 20 == 0)) {
-                                        if(belowTile.mat->physicsType == PhysicsType::AIR && getTile(x, y + 2).mat->physicsType == PhysicsType::AIR && getTile(x, y + 3).mat->physicsType == PhysicsType::AIR && getTile(x, y + 4).mat->physicsType == PhysicsType::AIR) {
-                                            setTile(x, y, belowTile);
-                                            #ifdef DO_MULTITHREADING
-                                            parts.push_back(new Particle(tile, x, y + 1, (rand() % 10 - 5) / 20.0f, -((rand() % 2) + 3) / 10.0f + 1.5f, 0, 0.1f));
-                                            #else
-                                            particles.push_back(new Particle(tile, x, y + 1, (rand() % 10 - 5) / 20.0f, -((rand() % 2) + 3) / 10.0f + 1.5f, 0, 0.1f));
-                                            #endif
-
-                                        } else {
-                                            tiles[index] = belowTile;
-                                            dirty[index] = true;
-                                            //setTile(x, y, belowTile);
-                                            //setTile(x, y + 1, tile);
-                                            tiles[(x)+(y + 1) * width] = tile;
-                                            dirty[(x)+(y + 1) * width] = true;
-                                            tickVisited[x + (y + 1) * width] = true;
-                                        }
-                                    }
+void World::wakeDirty() {
+    EASY_FUNCTION(WORLD_PROFILER_COLOR);
 
-                                } else if(type == PhysicsType::SOUP) {
-                                    //active[index] = true;
-                                    MaterialInstance belowTile = tiles[(x)+(y + 1) * width];
-                                    int below = belowTile.mat->physicsType;
-
-                                    if(mat->interact && belowTile.mat->id >= 0 && belowTile.mat->id < Materials::nMaterials && mat->nInteractions[belowTile.mat->id] > 0) {
-                                        for(int i = 0; i < mat->nInteractions[belowTile.mat->id]; i++) {
-                                            MaterialInteraction in = mat->interactions[belowTile.mat->id][i];
-                                            if(in.type == INTERACT_TRANSFORM_MATERIAL) {
-                                                for(int xx = in.ofsX - in.data2; xx <= in.ofsX + in.data2; xx++) {
-                                                    for(int yy = in.ofsY - in.data2; yy <= in.ofsY + in.data2; yy++) {
-                                                        if(tiles[(x + xx) + (y + yy) * width].mat->id == belowTile.mat->id) {
-                                                            tiles[(x + xx) + (y + yy) * width] = Tiles::create(Materials::MATERIALS[in.data1], x + xx, y + yy);
-                                                            dirty[(x + xx) + (y + yy) * width] = true;
-                                                            tickVisited[(x + xx) + (y + yy) * width] = true;
-                                                        }
-                                                    }
-                                                }
-                                            } else if(in.type == INTERACT_SPAWN_MATERIAL) {
-                                                for(int xx = in.ofsX - in.data2; xx <= in.ofsX + in.data2; xx++) {
-                                                    for(int yy = in.ofsY - in.data2; yy <= in.ofsY + in.data2; yy++) {
-                                                        if((xx == 0 && yy == 0) || tiles[(x + xx) + (y + yy) * width].mat->id == Tiles::NOTHING.mat->id) {
-                                                            tiles[(x + xx) + (y + yy) * width] = Tiles::create(Materials::MATERIALS[in.data1], x + xx, y + yy);
-                                                            dirty[(x + xx) + (y + yy) * width] = true;
-                                                            tickVisited[(x + xx) + (y + yy) * width] = true;
-                                                        }
-                                                    }
-                                                }
-                                            }
-                                        }
-                                        continue;
-                                    }
+    // most of dirty is false, so skip it 8 cells at a time
+    int n = width * height;
+    for(int i = 0; i < n; i += 8) {
+        uint64_t word;
+        memcpy(&word, &dirty[i], sizeof(word));
+        if(word == 0) continue;
 
-                                    if(mat->react && mat->nReactions > 0) {
-                                        bool react = false;
-                                        for(int i = 0; i < mat->nReactions; i++) {
-                                            MaterialInteraction in = mat->reactions[i];
-                                            if(in.type == REACT_TEMPERATURE_BELOW) {
-                                                if(tile.temperature < in.data1) {
-                                                    tiles[index] = Tiles::create(Materials::MATERIALS[in.data2], x, y);
-                                                    tiles[index].temperature = tile.temperature;
-                                                    dirty[index] = true;
-                                                    tickVisited[index] = true;
-                                                    react = true;
-                                                }
-                                            } else if(in.type == REACT_TEMPERATURE_ABOVE) {
-                                                if(tile.temperature > in.data1) {
-                                                    tiles[index] = Tiles::create(Materials::MATERIALS[in.data2], x, y);
-                                                    tiles[index].temperature = tile.temperature;
-                                                    dirty[index] = true;
-                                                    tickVisited[index] = true;
-                                                    react = true;
-                                                }
-                                            }
-                                        }
-                                        if(react) continue;
-                                    }
+        for(int j = i; j < i + 8; j++) {
+            if(dirty[j]) wake(j % width, j / width);
+        }
+    }
+}
 
-                                    /*if (mat->id == Materials::WATER.id && belowTile.mat->id == Materials::LAVA.id) {
-                                        tiles[index] = Tiles::createSteam();
-                                        dirty[index] = true;
-                                        tiles[(x)+(y + 1) * width] = Tiles::createObsidian(x, y + 1);
-                                        dirty[(x)+(y + 1) * width] = true;
-                                        tickVisited[(x)+(y + 1) * width] = true;
-
-                                        for (int xx = -1; xx <= 1; xx++) {
-                                            for (int yy = 0; yy <= 2; yy++) {
-                                                if (tiles[(x + xx) + (y + yy) * width].mat->id == Materials::LAVA.id) {
-                                                    tiles[(x + xx) + (y + yy) * width] = Tiles::createObsidian(x + xx, y + yy);
-                                                    dirty[(x + xx) + (y + yy) * width] = true;
-                                                    tickVisited[(x + xx) + (y + yy) * width] = true;
-                                                }
-                                            }
-                                        }
+void World::commitSimTiles() {
+    for(int i = 0; i < simTilesW * simTilesH; i++) {
+        SimTile& t = simTiles[i];
+        if(t.wake.empty()) continue;
 
-                                        continue;
-                                    }*/
-
-                                    bool canMoveBelow = (below == PhysicsType::AIR || (below != PhysicsType::SOLID && belowTile.mat->density < mat->density));
-                                    if(!canMoveBelow) continue;
-
-                                    MaterialInstance belowLTile = tiles[(x - 1) + (y + 1) * width];
-                                    int belowL = belowLTile.mat->physicsType;
-                                    MaterialInstance belowRTile = tiles[(x + 1) + (y + 1) * width];
-                                    int belowR = belowRTile.mat->physicsType;
-
-                                    bool canMoveBelowL = (belowL == PhysicsType::AIR || (belowL != PhysicsType::SOLID && belowLTile.mat->density < mat->density));
-                                    bool canMoveBelowR = (belowR == PhysicsType::AIR || (belowR != PhysicsType::SOLID && belowRTile.mat->density < mat->density));
-
-                                    if(canMoveBelow && !((canMoveBelowL || canMoveBelowR) && rand() % 10 == 0)) {
-                                        if(belowTile.mat->physicsType == PhysicsType::AIR && getTile(x, y + 2).mat->physicsType == PhysicsType::AIR && getTile(x, y + 3).mat->physicsType == PhysicsType::AIR && getTile(x, y + 4).mat->physicsType == PhysicsType::AIR) {
-                                            setTile(x, y, belowTile);
-                                            #ifdef DO_MULTITHREADING
-                                            parts.push_back(new Particle(tile, x, y + 1, (rand() % 10 - 5) / 20.0f, -((rand() % 2) + 3) / 10.0f + 1.5f, 0, 0.1f));
-                                            #else
-                                            particles.push_back(new Particle(tile, x, y + 1, (rand() % 10 - 5) / 20.0f, -((rand() % 2) + 3) / 10.0f + 1.5f, 0, 0.1f));
-                                            #endif
-                                        } else {
-                                            tiles[index] = belowTile;
-                                            dirty[index] = true;
-                                            //setTile(x, y, belowTile);
-                                            //setTile(x, y + 1, tile);
-                                            tiles[(x)+(y + 1) * width] = tile;
-                                            dirty[(x)+(y + 1) * width] = true;
-                                            tickVisited[x + (y + 1) * width] = true;
-                                        }
-                                    }
-                                } else if(type == PhysicsType::GAS) {
-                                    //active[index] = true;
-                                    int above = tiles[(x)+(y - 1) * width].mat->physicsType;
+        refreshLiveCells(t.wake.minX, t.wake.minY, t.wake.maxX, t.wake.maxY);
+        t.scan.add(t.wake.minX, t.wake.minY, t.wake.maxX, t.wake.maxY);
+        t.wake.clear();
+        t.sleep = SIM_SLEEP_TICKS;
+    }
+}
 
-                                    int aboveL = tiles[(x - 1) + (y - 1) * width].mat->physicsType;
-                                    int aboveR = tiles[(x + 1) + (y - 1) * width].mat->physicsType;
+void World::commitSimTiles(int cx, int cy) {
+    for(int ty = cy / SIM_TILE_H; ty < (cy + CHUNK_H) / SIM_TILE_H; ty++) {
+        for(int tx = cx / SIM_TILE_W; tx < (cx + CHUNK_W) / SIM_TILE_W; tx++) {
+            SimTile& t = simTiles[tx + ty * simTilesW];
+            if(t.wake.empty()) continue;
 
-                                    if(above == 0 && !((aboveL == 0 || aboveR == 0) && rand() % 2 == 0)) {
-                                        tiles[index] = getTile(x, y - 1);
-                                        dirty[index] = true;
+            refreshLiveCells(t.wake.minX, t.wake.minY, t.wake.maxX, t.wake.maxY);
+            t.scan.add(t.wake.minX, t.wake.minY, t.wake.maxX, t.wake.maxY);
+            t.wake.clear();
+            t.sleep = SIM_SLEEP_TICKS;
+        }
+    }
+}
 
-                                        tiles[(x)+(y - 1) * width] = tile;
-                                        dirty[(x)+(y - 1) * width] = true;
+void World::sleepSimTiles() {
+    for(int i = 0; i < simTilesW * simTilesH; i++) {
+        SimTile& t = simTiles[i];
+        if(t.sleep > 0 && --t.sleep == 0) {
+            t.scan.clear();
+        }
+    }
+}
 
-                                        tickVisited[(x)+(y - 1) * width] = true;
-                                    }
-                                }
-                            }
-                        }
-                        EASY_END_BLOCK;
-
-                        EASY_BLOCK("iter 2");
-                        for(int dy = CHUNK_H - 1; dy >= 0; dy--) {
-                            int y = cy + dy;
-                            for(int dx = CHUNK_W - 1; dx >= 0; dx--) {
-                                int x = cx + dx;
-                                int index = x + y * width;
-
-                                if(tickVisited[index]) continue;
-
-                                MaterialInstance tile = tiles[index];
-                                Material* mat = tile.mat;
-
-                                int type = mat->physicsType;
-                                if(type == PhysicsType::AIR) continue;
-
-                                if(type == PhysicsType::SAND) {
-                                    //active[index] = true;
-                                    MaterialInstance belowLTile = tiles[(x - 1) + (y + 1) * width];
-                                    int belowL = belowLTile.mat->physicsType;
-                                    MaterialInstance belowRTile = tiles[(x + 1) + (y + 1) * width];
-                                    int belowR = belowRTile.mat->physicsType;
-
-                                    bool canMoveBelowL = (belowL == PhysicsType::AIR || (belowL != PhysicsType::SOLID && belowLTile.mat->density < mat->density));
-                                    bool canMoveBelowR = (belowR == PhysicsType::AIR || (belowR != PhysicsType::SOLID && belowRTile.mat->density < mat->density));
-
-                                    if(!(canMoveBelowL || canMoveBelowR)) continue;
-
-                                    if(canMoveBelowL && (!canMoveBelowR || rand() % 2 == 0)) {
-                                        if(tiles[(x - 1) + y * width].mat->physicsType == PhysicsType::AIR) {
-                                            tiles[(x - 1) + y * width] = belowLTile;
-                                            dirty[(x - 1) + y * width] = true;
-                                            tickVisited[(x - 1) + (y)* width] = true;
-                                            tiles[index] = Tiles::NOTHING;
-                                            dirty[index] = true;
-                                        } else {
-                                            tiles[index] = belowLTile;
-                                            dirty[index] = true;
-                                            tickVisited[index] = true;
-                                        }
+void World::shiftSimTiles(int dx, int dy) {
+    EASY_FUNCTION(WORLD_PROFILER_COLOR);
 
-                                        tiles[(x - 1) + (y + 1) * width] = tile;
-                                        dirty[(x - 1) + (y + 1) * width] = true;
-                                        tickVisited[(x - 1) + (y + 1) * width] = true;
-                                    } else if(canMoveBelowR) {
-
-                                        if(tiles[(x + 1) + y * width].mat->physicsType == PhysicsType::AIR) {
-                                            tiles[(x + 1) + y * width] = belowRTile;
-                                            dirty[(x + 1) + y * width] = true;
-                                            tiles[index] = Tiles::NOTHING;
-                                            dirty[index] = true;
-                                        } else {
-                                            tiles[index] = belowRTile;
-                                            dirty[index] = true;
-                                            tickVisited[index] = true;
-                                        }
+    std::vector<SimTile> old(simTiles, simTiles + simTilesW * simTilesH);
+    for(int i = 0; i < simTilesW * simTilesH; i++) {
+        simTiles[i] = SimTile();
+    }
 
-                                        tiles[(x + 1) + (y + 1) * width] = tile;
-                                        dirty[(x + 1) + (y + 1) * width] = true;
-                                        tickVisited[(x + 1) + (y + 1) * width] = true;
-                                    }
-                                } else if(type == PhysicsType::SOUP) {
-                                    //active[index] = true;
-                                    MaterialInstance belowLTile = tiles[(x - 1) + (y + 1) * width];
-                                    int belowL = belowLTile.mat->physicsType;
-                                    MaterialInstance belowRTile = tiles[(x + 1) + (y + 1) * width];
-                                    int belowR = belowRTile.mat->physicsType;
-
-                                    bool canMoveBelowL = (belowL == PhysicsType::AIR || (belowL != PhysicsType::SOLID && belowLTile.mat->density < mat->density));
-                                    bool canMoveBelowR = (belowR == PhysicsType::AIR || (belowR != PhysicsType::SOLID && belowRTile.mat->density < mat->density));
-
-                                    if(!(canMoveBelowL || canMoveBelowR)) continue;
-
-                                    MaterialInstance lTile = tiles[(x - 1) + (y)* width];
-                                    int l = lTile.mat->physicsType;
-                                    MaterialInstance rTile = tiles[(x + 1) + (y)* width];
-                                    int r = rTile.mat->physicsType;
-
-                                    bool canMoveL = (l == PhysicsType::AIR || (l != PhysicsType::SOLID && lTile.mat->density < mat->density));
-                                    bool canMoveR = (r == PhysicsType::AIR || (r != PhysicsType::SOLID && rTile.mat->density < mat->density));
-
-                                    if(!((canMoveL || canMoveR) && rand() % 10 < 0)) {
-                                        if(canMoveBelowL && !(canMoveBelowR && rand() % 2 == 0)) {
-                                            if(tiles[(x - 1) + y * width].mat->physicsType == PhysicsType::AIR) {
-                                                tiles[(x - 1) + y * width] = belowLTile;
-                                                dirty[(x - 1) + y * width] = true;
-                                                tiles[index] = Tiles::NOTHING;
-                                                dirty[index] = true;
-                                            } else {
-                                                tiles[index] = belowLTile;
-                                                dirty[index] = true;
-                                            }
+    // carry over the awake areas as fresh wakes, they get committed on the next tick
+    for(auto& t : old) {
+        if(!t.scan.empty()) wakeArea(t.scan.minX + dx, t.scan.minY + dy, t.scan.maxX + dx, t.scan.maxY + dy);
+        if(!t.wake.empty()) wakeArea(t.wake.minX + dx, t.wake.minY + dy, t.wake.maxX + dx, t.wake.maxY + dy);
+        if(!t.heatWake.empty()) heatArea(t.heatWake.minX + dx, t.heatWake.minY + dy, t.heatWake.maxX + dx, t.heatWake.maxY + dy);
+    }
 
-                                            tiles[(x - 1) + (y + 1) * width] = tile;
-                                            dirty[(x - 1) + (y + 1) * width] = true;
-                                            tickVisited[(x - 1) + (y + 1) * width] = true;
-                                        } else if(canMoveBelowR) {
-                                            if(tiles[(x + 1) + y * width].mat->physicsType == PhysicsType::AIR) {
-                                                tiles[(x + 1) + y * width] = belowRTile;
-                                                dirty[(x + 1) + y * width] = true;
-                                                tiles[index] = Tiles::NOTHING;
-                                                dirty[index] = true;
-                                            } else {
-                                                tiles[index] = belowRTile;
-                                                dirty[index] = true;
-                                            }
+    // warm tiles get a full pass, which works out whether they still are
+    for(int ty = 0; ty < simTilesH; ty++) {
+        for(int tx = 0; tx < simTilesW; tx++) {
+            if(!old[tx + ty * simTilesW].warm) continue;
+            int x = tx * SIM_TILE_W + dx;
+            int y = ty * SIM_TILE_H + dy;
+            heatArea(x, y, x + SIM_TILE_W - 1, y + SIM_TILE_H - 1);
+        }
+    }
+}
 
-                                            tiles[(x + 1) + (y + 1) * width] = tile;
-                                            dirty[(x + 1) + (y + 1) * width] = true;
-                                            tickVisited[(x + 1) + (y + 1) * width] = true;
-                                        }
-                                    }
-                                } else if(type == PhysicsType::GAS) {
-                                    //active[index] = true;
-                                    int aboveL = tiles[(x - 1) + (y - 1) * width].mat->physicsType;
-                                    int aboveR = tiles[(x + 1) + (y - 1) * width].mat->physicsType;
-
-                                    if(aboveL == 0 && !(aboveR == 0 && rand() % 2 == 0)) {
-                                        tiles[index] = tiles[(x - 1) + (y - 1) * width];
-                                        dirty[index] = true;
-
-                                        tiles[(x - 1) + (y - 1) * width] = tile;
-                                        dirty[(x - 1) + (y - 1) * width] = true;
-                                        tickVisited[(x - 1) + (y - 1) * width] = true;
-                                    } else if(aboveR == 0) {
-                                        tiles[index] = tiles[(x + 1) + (y - 1) * width];
-                                        dirty[index] = true;
-
-                                        tiles[(x + 1) + (y - 1) * width] = tile;
-                                        dirty[(x + 1) + (y - 1) * width] = true;
-                                        tickVisited[(x + 1) + (y - 1) * width] = true;
-                                    }
-                                }
-                            }
-                        }
-                        EASY_END_BLOCK;
+bool World::simChunkAwake(int cx, int cy) {
+    for(int ty = cy / SIM_TILE_H; ty < (cy + CHUNK_H) / SIM_TILE_H; ty++) {
+        for(int tx = cx / SIM_TILE_W; tx < (cx + CHUNK_W) / SIM_TILE_W; tx++) {
+            if(!simTiles[tx + ty * simTilesW].scan.empty()) return true;
+        }
+    }
+    return false;
+}
 
-                        EASY_BLOCK("iter 3");
-                        for(int dy = CHUNK_H - 1; dy >= 0; dy--) {
-                            int y = cy + dy;
-                            for(int dx = CHUNK_W - 1; dx >= 0; dx--) {
-                                int x = cx + dx;
-                                int index = x + y * width;
+bool World::simRowRange(int cx, int y, int* minX, int* maxX) {
+    // union of the awake parts of this row, so the scan order within the row stays the same
+    *minX = INT_MAX;
+    *maxX = INT_MIN;
+    int ty = y / SIM_TILE_H;
+    for(int tx = cx / SIM_TILE_W; tx < (cx + CHUNK_W) / SIM_TILE_W; tx++) {
+        SimRect& r = simTiles[tx + ty * simTilesW].scan;
+        if(y < r.minY || y > r.maxY) continue;
+        if(r.minX < *minX) *minX = r.minX;
+        if(r.maxX > *maxX) *maxX = r.maxX;
+    }
+    return *minX <= *maxX;
+}
 
-                                if(tickVisited[index]) continue;
+// whether a cell of material `mover` can swap places with `other`
+static inline bool canDisplace(const MaterialInstance& mover, const MaterialInstance& other) {
+    int type = Materials::PHYSICS_TYPE[other.mat.id];
+    return type == PhysicsType::AIR || (type != PhysicsType::SOLID && Materials::DENSITY[other.mat.id] < Materials::DENSITY[mover.mat.id]);
+}
 
-                                MaterialInstance tile = tiles[index];
-                                Material* mat = tile.mat;
+bool World::tickInteractions(int x, int y, MaterialInstance tile, MaterialInstance belowTile, ChunkTickState& st) {
+    if(!Materials::hasInteraction(tile.mat.id, belowTile.mat.id)) return false;
+
+    int p = tile.mat.id * Materials::nMaterials + belowTile.mat.id;
+    for(uint32_t i = Materials::INTERACTION_START[p]; i < Materials::INTERACTION_START[p + 1]; i++) {
+        const MaterialInteraction& in = Materials::INTERACTIONS[i];
+        if(in.type == INTERACT_TRANSFORM_MATERIAL) {
+            for(int xx = in.ofsX - in.data2; xx <= in.ofsX + in.data2; xx++) {
+                for(int yy = in.ofsY - in.data2; yy <= in.ofsY + in.data2; yy++) {
+                    if(tiles[(x + xx) + (y + yy) * width].mat.id == belowTile.mat.id) {
+                        tiles[(x + xx) + (y + yy) * width] = Tiles::create(Materials::MATERIALS[in.data1], x + xx, y + yy);
+                        markDirty((x + xx) + (y + yy) * width);
+                        tickVisited[(x + xx) + (y + yy) * width] = st.visit;
+                    }
+                }
+            }
+        } else if(in.type == INTERACT_SPAWN_MATERIAL) {
+            for(int xx = in.ofsX - in.data2; xx <= in.ofsX + in.data2; xx++) {
+                for(int yy = in.ofsY - in.data2; yy <= in.ofsY + in.data2; yy++) {
+                    if((xx == 0 && yy == 0) || tiles[(x + xx) + (y + yy) * width].mat.id == Tiles::NOTHING.mat.id) {
+                        tiles[(x + xx) + (y + yy) * width] = Tiles::create(Materials::MATERIALS[in.data1], x + xx, y + yy);
+                        markDirty((x + xx) + (y + yy) * width);
+                        tickVisited[(x + xx) + (y + yy) * width] = st.visit;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
 
-                                int type = mat->physicsType;
-                                if(type == PhysicsType::AIR) continue;
+void World::tickFall(int x, int y, MaterialInstance tile, MaterialInstance belowTile, int slideChance, ChunkTickState& st) {
+    int index = x + y * width;
 
-                                if(type == PhysicsType::SOUP) {
-                                    //active[index] = true;
+    if(!canDisplace(tile, belowTile)) return;
 
-                                    MaterialInstance lTile = tiles[(x - 1) + (y)* width];
-                                    int l = lTile.mat->physicsType;
-                                    MaterialInstance rTile = tiles[(x + 1) + (y)* width];
-                                    int r = rTile.mat->physicsType;
+    bool canMoveBelowL = canDisplace(tile, tiles[(x - 1) + (y + 1) * width]);
+    bool canMoveBelowR = canDisplace(tile, tiles[(x + 1) + (y + 1) * width]);
 
-                                    bool canMoveL = (l == PhysicsType::AIR || (l != PhysicsType::SOLID && lTile.mat->density < mat->density));
-                                    bool canMoveR = (r == PhysicsType::AIR || (r != PhysicsType::SOLID && rTile.mat->density < mat->density));
+    // now and then leave it to the diagonal pass instead, so piles spread out
+    if((canMoveBelowL || canMoveBelowR) && st.rng.next() % slideChance == 0) return;
 
-                                    if(canMoveL && !(canMoveR && rand() % 2 == 7)) {
-                                        tiles[index] = lTile;
-                                        dirty[index] = true;
+    if(Materials::PHYSICS_TYPE[belowTile.mat.id] == PhysicsType::AIR && Materials::PHYSICS_TYPE[getTile(x, y + 2).mat.id] == PhysicsType::AIR && Materials::PHYSICS_TYPE[getTile(x, y + 3).mat.id] == PhysicsType::AIR && Materials::PHYSICS_TYPE[getTile(x, y + 4).mat.id] == PhysicsType::AIR) {
+        // a long drop becomes a particle
+        setTile(x, y, belowTile);
+        st.parts.push_back(Particle(tile, x, y + 1, (st.rng.next() % 10 - 5) / 20.0f, -((st.rng.next() % 2) + 3) / 10.0f + 1.5f, 0, 0.1f));
+    } else {
+        tiles[index] = belowTile;
+        markDirty(index);
+        tiles[(x)+(y + 1) * width] = tile;
+        markDirty((x)+(y + 1) * width);
+        tickVisited[x + (y + 1) * width] = st.visit;
+    }
+}
 
-                                        tiles[(x - 1) + (y)* width] = tile;
-                                        dirty[(x - 1) + (y)* width] = true;
-                                        tickVisited[(x - 1) + (y)* width] = true;
-                                    } else if(canMoveR) {
-                                        tiles[index] = rTile;
-                                        dirty[index] = true;
+void World::tickSlide(int x, int y, MaterialInstance tile, int side, bool markMoved, ChunkTickState& st) {
+    int index = x + y * width;
+    int target = (x + side) + (y + 1) * width;
+    MaterialInstance belowTile = tiles[target];
+
+    if(Materials::PHYSICS_TYPE[tiles[(x + side) + y * width].mat.id] == PhysicsType::AIR) {
+        tiles[(x + side) + y * width] = belowTile;
+        markDirty((x + side) + y * width);
+        tickVisited[(x + side) + y * width] = st.visit;
+        tiles[index] = Tiles::NOTHING;
+        markDirty(index);
+    } else {
+        tiles[index] = belowTile;
+        markDirty(index);
+        if(markMoved) tickVisited[index] = st.visit;
+    }
 
-                                        tiles[(x + 1) + (y)* width] = tile;
-                                        dirty[(x + 1) + (y)* width] = true;
-                                        tickVisited[(x + 1) + (y)* width] = true;
-                                    }
-                                } else if(type == PhysicsType::GAS) {
-                                    //active[index] = true;
-
-                                    int l = tiles[(x - 1) + (y)* width].mat->physicsType;
-                                    int r = tiles[(x + 1) + (y)* width].mat->physicsType;
-
-                                    if(l == 0 && !(r == 0 && rand() % 2 == 0)) {
-                                        tiles[index] = getTile(x - 1, y);
-                                        dirty[index] = true;
-
-                                        tiles[(x - 1) + (y)* width] = tile;
-                                        dirty[(x - 1) + (y)* width] = true;
-                                        tickVisited[(x - 1) + (y)* width] = true;
-                                    } else if(r == 0) {
-                                        tiles[index] = getTile(x + 1, y);
-                                        dirty[index] = true;
-
-                                        tiles[(x + 1) + (y)* width] = tile;
-                                        dirty[(x + 1) + (y)* width] = true;
-                                        tickVisited[(x + 1) + (y)* width] = true;
-                                    } else {
-                                        if(mat->id == Materials::STEAM.id) {
-                                            if(rand() % 10 == 0) {
-                                                tiles[index] = Tiles::createWater();
-                                                dirty[index] = true;
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                        EASY_END_BLOCK;
-                        EASY_END_BLOCK;
-                    } else {
-                        #endif
-                        EASY_BLOCK("chunk");
-                        EASY_BLOCK("iter 1");
-                        for(int dy = CHUNK_H - 1; dy >= 0; dy--) {
-                            int y = cy + dy;
-                            for(int dx = 0; dx < CHUNK_W; dx++) {
-                                int x = cx + dx;
-                                int index = x + y * width;
-
-                                if(tickVisited[index]) continue;
-
-                                if(iter >= tiles[index].mat->iterations) {
-                                    tickVisited[index] = true;
-                                    continue;
-                                }
-                                MaterialInstance tile = tiles[index];
+    tiles[target] = tile;
+    markDirty(target);
+    tickVisited[target] = st.visit;
+}
 
-                                int type = tile.mat->physicsType;
+void World::tickSwap(int index, int other, ChunkTickState& st) {
+    MaterialInstance tile = tiles[index];
+    tiles[index] = tiles[other];
+    markDirty(index);
+    tiles[other] = tile;
+    markDirty(other);
+    tickVisited[other] = st.visit;
+}
 
-                                if(tile.mat->id == Materials::FIRE.id) {
-                                    if(rand() % 10 == 0) {
-                                        Uint32 rgb = 255;
-                                        rgb = (rgb << 8) + 100 + rand() % 50;
-                                        rgb = (rgb << 8) + 50;
-                                        tile.color = rgb;
-                                    }
+// cells with no behaviour in a pass (air, solids, objects) fall through to here
+template<int pass, int type>
+void World::tickCell(int x, int y, int index, ChunkTickState& st) {}
 
-                                    if(rand() % 10 == 0) {
-                                        Particle* p = new Particle(tile, x, y - 1, (rand() % 10 - 5) / 20.0f, -((rand() % 10) / 10.0f) / 3.0f + -0.5f, 0, 0.01f);
-                                        p->temporary = true;
-                                        p->lifetime = 30;
-                                        p->fadeTime = 10;
-                                        #ifdef DO_MULTITHREADING
-                                        parts.push_back(p);
-                                        #else
-                                        particles.push_back(p);
-                                        #endif
-                                    }
+// fire is the only PASSABLE material that does anything
+template<>
+void World::tickCell<1, PhysicsType::PASSABLE>(int x, int y, int index, ChunkTickState& st) {
+    MaterialInstance tile = tiles[index];
+    if(tile.mat.id != Materials::FIRE.id) return;
 
-                                    if(rand() % 150 == 0) {
-                                        //tiles[index] = Tiles::createSteam();
-                                        tiles[index] = Tiles::NOTHING;
-                                        dirty[index] = true;
-                                        tickVisited[index] = true;
-                                    } else {
-                                        bool foundAny = false;
-                                        for(int xx = -2; xx <= 2; xx++) {
-                                            for(int yy = -2; yy <= 2; yy++) {
-                                                if(tiles[(x + xx) + (y + yy) * width].mat->physicsType == PhysicsType::SOLID) {
-                                                    foundAny = true;
-                                                    if(rand() % 500 == 0) {
-                                                        tiles[(x + xx) + (y + yy) * width] = Tiles::createFire();
-                                                        dirty[(x + xx) + (y + yy) * width] = true;
-                                                        tickVisited[(x + xx) + (y + yy) * width] = true;
-                                                    }
-                                                }
-                                            }
-                                        }
-                                        if(!foundAny && rand() % 120 == 0) {
-                                            tiles[index] = Tiles::NOTHING;
-                                            dirty[index] = true;
-                                            tickVisited[index] = true;
-                                        }
-                                    }
-                                }
+    tickVisited[index] = st.visit;
+    // fire flickers and spreads at random, so it never settles
+    wake(x, y);
 
-                                if(type == PhysicsType::SAND) {
-                                    //active[index] = true;
-                                    MaterialInstance belowTile = tiles[x + (y + 1) * width];
-                                    int below = belowTile.mat->physicsType;
-
-                                    if(tile.mat->interact && belowTile.mat->id >= 0 && belowTile.mat->id < Materials::nMaterials && tile.mat->nInteractions[belowTile.mat->id] > 0) {
-                                        for(int i = 0; i < tile.mat->nInteractions[belowTile.mat->id]; i++) {
-                                            MaterialInteraction in = tile.mat->interactions[belowTile.mat->id][i];
-                                            if(in.type == INTERACT_TRANSFORM_MATERIAL) {
-                                                for(int xx = in.ofsX - in.data2; xx <= in.ofsX + in.data2; xx++) {
-                                                    for(int yy = in.ofsY - in.data2; yy <= in.ofsY + in.data2; yy++) {
-                                                        if(tiles[(x + xx) + (y + yy) * width].mat->id == belowTile.mat->id) {
-                                                            tiles[(x + xx) + (y + yy) * width] = Tiles::create(Materials::MATERIALS[in.data1], x + xx, y + yy);
-                                                            dirty[(x + xx) + (y + yy) * width] = true;
-                                                            tickVisited[(x + xx) + (y + yy) * width] = true;
-                                                        }
-                                                    }
-                                                }
-                                            } else if(in.type == INTERACT_SPAWN_MATERIAL) {
-                                                for(int xx = in.ofsX - in.data2; xx <= in.ofsX + in.data2; xx++) {
-                                                    for(int yy = in.ofsY - in.data2; yy <= in.ofsY + in.data2; yy++) {
-                                                        if((xx == 0 && yy == 0) || tiles[(x + xx) + (y + yy) * width].mat->id == Tiles::NOTHING.mat->id) {
-                                                            tiles[(x + xx) + (y + yy) * width] = Tiles::create(Materials::MATERIALS[in.data1], x + xx, y + yy);
-                                                            dirty[(x + xx) + (y + yy) * width] = true;
-                                                            tickVisited[(x + xx) + (y + yy) * width] = true;
-                                                        }
-                                                    }
-                                                }
-                                            }
-                                        }
-                                        continue;
-                                    }
+    if(st.rng.next() % 10 == 0) {
+        Uint32 rgb = 255;
+        rgb = (rgb << 8) + 100 + st.rng.next() % 50;
+        rgb = (rgb << 8) + 50;
+        tile.color = rgb;
+    }
 
-                                    if(tile.mat->react && tile.mat->nReactions > 0) {
-                                        bool react = false;
-                                        for(int i = 0; i < tile.mat->nReactions; i++) {
-                                            MaterialInteraction in = tile.mat->reactions[i];
-                                            if(in.type == REACT_TEMPERATURE_BELOW) {
-                                                if(tile.temperature < in.data1) {
-                                                    tiles[index] = Tiles::create(Materials::MATERIALS[in.data2], x, y);
-                                                    tiles[index].temperature = tile.temperature;
-                                                    dirty[index] = true;
-                                                    tickVisited[index] = true;
-                                                    react = true;
-                                                }
-                                            } else if(in.type == REACT_TEMPERATURE_ABOVE) {
-                                                if(tile.temperature > in.data1) {
-                                                    tiles[index] = Tiles::create(Materials::MATERIALS[in.data2], x, y);
-                                                    tiles[index].temperature = tile.temperature;
-                                                    dirty[index] = true;
-                                                    tickVisited[index] = true;
-                                                    react = true;
-                                                }
-                                            }
-                                        }
-                                        if(react) continue;
-                                    }
+    if(st.rng.next() % 10 == 0) {
+        Particle p(tile, x, y - 1, (st.rng.next() % 10 - 5) / 20.0f, -((st.rng.next() % 10) / 10.0f) / 3.0f + -0.5f, 0, 0.01f);
+        p.temporary = true;
+        p.lifetime = 30;
+        p.fadeTime = 10;
+        st.parts.push_back(p);
+    }
 
-                                    bool canMoveBelow = (below == PhysicsType::AIR || (below != PhysicsType::SOLID && belowTile.mat->density < tile.mat->density));
-                                    if(!canMoveBelow) continue;
-
-                                    MaterialInstance belowLTile = tiles[(x - 1) + (y + 1) * width];
-                                    int belowL = belowLTile.mat->physicsType;
-                                    MaterialInstance belowRTile = tiles[(x + 1) + (y + 1) * width];
-                                    int belowR = belowRTile.mat->physicsType;
-
-                                    bool canMoveBelowL = (belowL == PhysicsType::AIR || (belowL != PhysicsType::SOLID && belowLTile.mat->density < tile.mat->density));
-                                    bool canMoveBelowR = (belowR == PhysicsType::AIR || (belowR != PhysicsType::SOLID && belowRTile.mat->density < tile.mat->density));
-
-                                    if(canMoveBelow && !((canMoveBelowL || canMoveBelowR) && rand() % 20 == 0)) {
-                                        if(belowTile.mat->physicsType == PhysicsType::AIR && getTile(x, y + 2).mat->physicsType == PhysicsType::AIR && getTile(x, y + 3).mat->physicsType == PhysicsType::AIR && getTile(x, y + 4).mat->physicsType == PhysicsType::AIR) {
-                                            setTile(x, y, belowTile);
-                                            #ifdef DO_MULTITHREADING
-                                            parts.push_back(new Particle(tile, x, y + 1, (rand() % 10 - 5) / 20.0f, -((rand() % 2) + 3) / 10.0f + 1.5f, 0, 0.1f));
-                                            #else
-                                            particles.push_back(new Particle(tile, x, y + 1, (rand() % 10 - 5) / 20.0f, -((rand() % 2) + 3) / 10.0f + 1.5f, 0, 0.1f));
-                                            #endif
-                                        } else {
-                                            tiles[index] = belowTile;
-                                            dirty[index] = true;
-                                            //setTile(x, y, belowTile);
-                                            //setTile(x, y + 1, tile);
-                                            tiles[(x)+(y + 1) * width] = tile;
-                                            dirty[(x)+(y + 1) * width] = true;
-                                            tickVisited[x + (y + 1) * width] = true;
-                                        }
-                                    }
+    if(st.rng.next() % 150 == 0) {
+        tiles[index] = Tiles::createSteam();
+        markDirty(index);
+    } else {
+        bool foundAny = false;
+        for(int xx = -2; xx <= 2; xx++) {
+            for(int yy = -2; yy <= 2; yy++) {
+                int spread = (x + xx) + (y + yy) * width;
+                if(Materials::PHYSICS_TYPE[tiles[spread].mat.id] == PhysicsType::SOLID) {
+                    foundAny = true;
+                    if(st.rng.next() % 500 == 0) {
+                        tiles[spread] = Tiles::createFire();
+                        markDirty(spread);
+                        tickVisited[spread] = st.visit;
+                    }
+                }
+            }
+        }
+        if(!foundAny && st.rng.next() % 120 == 0) {
+            tiles[index] = Tiles::NOTHING;
+            markDirty(index);
+        }
+    }
+}
 
-                                } else if(type == PhysicsType::SOUP) {
-                                    //active[index] = true;
-                                    MaterialInstance belowTile = tiles[(x)+(y + 1) * width];
-                                    int below = belowTile.mat->physicsType;
-
-                                    if(tile.mat->interact && belowTile.mat->id >= 0 && belowTile.mat->id < Materials::nMaterials && tile.mat->nInteractions[belowTile.mat->id] > 0) {
-                                        for(int i = 0; i < tile.mat->nInteractions[belowTile.mat->id]; i++) {
-                                            MaterialInteraction in = tile.mat->interactions[belowTile.mat->id][i];
-                                            if(in.type == INTERACT_TRANSFORM_MATERIAL) {
-                                                for(int xx = in.ofsX - in.data2; xx <= in.ofsX + in.data2; xx++) {
-                                                    for(int yy = in.ofsY - in.data2; yy <= in.ofsY + in.data2; yy++) {
-                                                        if(tiles[(x + xx) + (y + yy) * width].mat->id == belowTile.mat->id) {
-                                                            tiles[(x + xx) + (y + yy) * width] = Tiles::create(Materials::MATERIALS[in.data1], x + xx, y + yy);
-                                                            dirty[(x + xx) + (y + yy) * width] = true;
-                                                            tickVisited[(x + xx) + (y + yy) * width] = true;
-                                                        }
-                                                    }
-                                                }
-                                            } else if(in.type == INTERACT_SPAWN_MATERIAL) {
-                                                for(int xx = in.ofsX - in.data2; xx <= in.ofsX + in.data2; xx++) {
-                                                    for(int yy = in.ofsY - in.data2; yy <= in.ofsY + in.data2; yy++) {
-                                                        if((xx == 0 && yy == 0) || tiles[(x + xx) + (y + yy) * width].mat->id == Tiles::NOTHING.mat->id) {
-                                                            tiles[(x + xx) + (y + yy) * width] = Tiles::create(Materials::MATERIALS[in.data1], x + xx, y + yy);
-                                                            dirty[(x + xx) + (y + yy) * width] = true;
-                                                            tickVisited[(x + xx) + (y + yy) * width] = true;
-                                                        }
-                                                    }
-                                                }
-                                            }
-                                        }
-                                        continue;
-                                    }
+template<>
+void World::tickCell<1, PhysicsType::SAND>(int x, int y, int index, ChunkTickState& st) {
+    MaterialInstance tile = tiles[index];
+    MaterialInstance belowTile = tiles[x + (y + 1) * width];
 
-                                    if(tile.mat->react && tile.mat->nReactions > 0) {
-                                        bool react = false;
-                                        for(int i = 0; i < tile.mat->nReactions; i++) {
-                                            MaterialInteraction in = tile.mat->reactions[i];
-                                            if(in.type == REACT_TEMPERATURE_BELOW) {
-                                                if(tile.temperature < in.data1) {
-                                                    tiles[index] = Tiles::create(Materials::MATERIALS[in.data2], x, y);
-                                                    tiles[index].temperature = tile.temperature;
-                                                    dirty[index] = true;
-                                                    tickVisited[index] = true;
-                                                    react = true;
-                                                }
-                                            } else if(in.type == REACT_TEMPERATURE_ABOVE) {
-                                                if(tile.temperature > in.data1) {
-                                                    tiles[index] = Tiles::create(Materials::MATERIALS[in.data2], x, y);
-                                                    tiles[index].temperature = tile.temperature;
-                                                    dirty[index] = true;
-                                                    tickVisited[index] = true;
-                                                    react = true;
-                                                }
-                                            }
-                                        }
-                                        if(react) continue;
-                                    }
+    if(tickInteractions(x, y, tile, belowTile, st)) return;
+    tickFall(x, y, tile, belowTile, 20, st);
+}
 
-                                    /*if (tile.mat->id == Materials::WATER.id && belowTile.mat->id == Materials::LAVA.id) {
-                                        tiles[index] = Tiles::createSteam();
-                                        dirty[index] = true;
-                                        tiles[(x)+(y + 1) * width] = Tiles::createObsidian(x, y + 1);
-                                        dirty[(x)+(y + 1) * width] = true;
-                                        tickVisited[(x)+(y + 1) * width] = true;
-
-                                        for (int xx = -1; xx <= 1; xx++) {
-                                            for (int yy = 0; yy <= 2; yy++) {
-                                                if (tiles[(x + xx) + (y + yy) * width].mat->id == Materials::LAVA.id) {
-                                                    tiles[(x + xx) + (y + yy) * width] = Tiles::createObsidian(x + xx, y + yy);
-                                                    dirty[(x + xx) + (y + yy) * width] = true;
-                                                    tickVisited[(x + xx) + (y + yy) * width] = true;
-                                                }
-                                            }
-                                        }
+template<>
+void World::tickCell<1, PhysicsType::SOUP>(int x, int y, int index, ChunkTickState& st) {
+    MaterialInstance tile = tiles[index];
+    MaterialInstance belowTile = tiles[x + (y + 1) * width];
 
-                                        continue;
-                                    }*/
-
-                                    bool canMoveBelow = (below == PhysicsType::AIR || (below != PhysicsType::SOLID && belowTile.mat->density < tile.mat->density));
-                                    if(!canMoveBelow) continue;
-
-                                    MaterialInstance belowLTile = tiles[(x - 1) + (y + 1) * width];
-                                    int belowL = belowLTile.mat->physicsType;
-                                    MaterialInstance belowRTile = tiles[(x + 1) + (y + 1) * width];
-                                    int belowR = belowRTile.mat->physicsType;
-
-                                    bool canMoveBelowL = (belowL == PhysicsType::AIR || (belowL != PhysicsType::SOLID && belowLTile.mat->density < tile.mat->density));
-                                    bool canMoveBelowR = (belowR == PhysicsType::AIR || (belowR != PhysicsType::SOLID && belowRTile.mat->density < tile.mat->density));
-
-                                    if(canMoveBelow && !((canMoveBelowL || canMoveBelowR) && rand() % 10 == 0)) {
-                                        if(belowTile.mat->physicsType == PhysicsType::AIR && getTile(x, y + 2).mat->physicsType == PhysicsType::AIR && getTile(x, y + 3).mat->physicsType == PhysicsType::AIR && getTile(x, y + 4).mat->physicsType == PhysicsType::AIR) {
-                                            setTile(x, y, belowTile);
-                                            #ifdef DO_MULTITHREADING
-                                            parts.push_back(new Particle(tile, x, y + 1, (rand() % 10 - 5) / 20.0f, -((rand() % 2) + 3) / 10.0f + 1.5f, 0, 0.1f));
-                                            #else
-                                            particles.push_back(new Particle(tile, x, y + 1, (rand() % 10 - 5) / 20.0f, -((rand() % 2) + 3) / 10.0f + 1.5f, 0, 0.1f));
-                                            #endif
-                                        } else {
-                                            tiles[index] = belowTile;
-                                            dirty[index] = true;
-                                            //setTile(x, y, belowTile);
-                                            //setTile(x, y + 1, tile);
-                                            tiles[(x)+(y + 1) * width] = tile;
-                                            dirty[(x)+(y + 1) * width] = true;
-                                            tickVisited[x + (y + 1) * width] = true;
-                                        }
-                                    }
-                                } else if(type == PhysicsType::GAS) {
-                                    //active[index] = true;
-                                    int above = tiles[(x)+(y - 1) * width].mat->physicsType;
+    if(tickInteractions(x, y, tile, belowTile, st)) return;
+    tickFall(x, y, tile, belowTile, 10, st);
+}
 
-                                    int aboveL = tiles[(x - 1) + (y - 1) * width].mat->physicsType;
-                                    int aboveR = tiles[(x + 1) + (y - 1) * width].mat->physicsType;
+template<>
+void World::tickCell<1, PhysicsType::GAS>(int x, int y, int index, ChunkTickState& st) {
+    int above = Materials::PHYSICS_TYPE[tiles[(x)+(y - 1) * width].mat.id];
+    int aboveL = Materials::PHYSICS_TYPE[tiles[(x - 1) + (y - 1) * width].mat.id];
+    int aboveR = Materials::PHYSICS_TYPE[tiles[(x + 1) + (y - 1) * width].mat.id];
 
-                                    if(above == 0 && !((aboveL == 0 || aboveR == 0) && rand() % 2 == 0)) {
-                                        tiles[index] = getTile(x, y - 1);
-                                        dirty[index] = true;
+    if(above == PhysicsType::AIR && !((aboveL == PhysicsType::AIR || aboveR == PhysicsType::AIR) && st.rng.next() % 2 == 0)) {
+        tickSwap(index, (x)+(y - 1) * width, st);
+    }
+}
 
-                                        tiles[(x)+(y - 1) * width] = tile;
-                                        dirty[(x)+(y - 1) * width] = true;
+template<>
+void World::tickCell<2, PhysicsType::SAND>(int x, int y, int index, ChunkTickState& st) {
+    MaterialInstance tile = tiles[index];
+    bool canMoveBelowL = canDisplace(tile, tiles[(x - 1) + (y + 1) * width]);
+    bool canMoveBelowR = canDisplace(tile, tiles[(x + 1) + (y + 1) * width]);
 
-                                        tickVisited[(x)+(y - 1) * width] = true;
-                                    }
-                                }
-                            }
-                        }
-                        EASY_END_BLOCK;
-
-                        EASY_BLOCK("iter 2");
-                        for(int dy = CHUNK_H - 1; dy >= 0; dy--) {
-                            int y = cy + dy;
-                            for(int dx = 0; dx < CHUNK_W; dx++) {
-                                int x = cx + dx;
-                                int index = x + y * width;
-
-                                if(tickVisited[index]) continue;
-
-                                MaterialInstance tile = tiles[index];
-
-                                int type = tile.mat->physicsType;
-
-                                if(type == PhysicsType::SAND) {
-                                    //active[index] = true;
-                                    MaterialInstance belowLTile = tiles[(x - 1) + (y + 1) * width];
-                                    int belowL = belowLTile.mat->physicsType;
-                                    MaterialInstance belowRTile = tiles[(x + 1) + (y + 1) * width];
-                                    int belowR = belowRTile.mat->physicsType;
-
-                                    bool canMoveBelowL = (belowL == PhysicsType::AIR || (belowL != PhysicsType::SOLID && belowLTile.mat->density < tile.mat->density));
-                                    bool canMoveBelowR = (belowR == PhysicsType::AIR || (belowR != PhysicsType::SOLID && belowRTile.mat->density < tile.mat->density));
-
-                                    if(!(canMoveBelowL || canMoveBelowR)) continue;
-
-                                    if(canMoveBelowL && (!canMoveBelowR || rand() % 2 == 0)) {
-                                        if(tiles[(x - 1) + y * width].mat->physicsType == PhysicsType::AIR) {
-                                            tiles[(x - 1) + y * width] = belowLTile;
-                                            dirty[(x - 1) + y * width] = true;
-                                            tickVisited[(x - 1) + (y)* width] = true;
-                                            tiles[index] = Tiles::NOTHING;
-                                            dirty[index] = true;
-                                        } else {
-                                            tiles[index] = belowLTile;
-                                            dirty[index] = true;
-                                            tickVisited[index] = true;
-                                        }
+    if(canMoveBelowL && (!canMoveBelowR || st.rng.next() % 2 == 0)) {
+        tickSlide(x, y, tile, -1, true, st);
+    } else if(canMoveBelowR) {
+        tickSlide(x, y, tile, 1, true, st);
+    }
+}
 
-                                        tiles[(x - 1) + (y + 1) * width] = tile;
-                                        dirty[(x - 1) + (y + 1) * width] = true;
-                                        tickVisited[(x - 1) + (y + 1) * width] = true;
-                                    } else if(canMoveBelowR) {
-
-                                        if(tiles[(x + 1) + y * width].mat->physicsType == PhysicsType::AIR) {
-                                            tiles[(x + 1) + y * width] = belowRTile;
-                                            dirty[(x + 1) + y * width] = true;
-                                            tiles[index] = Tiles::NOTHING;
-                                            dirty[index] = true;
-                                        } else {
-                                            tiles[index] = belowRTile;
-                                            dirty[index] = true;
-                                            tickVisited[index] = true;
-                                        }
+template<>
+void World::tickCell<2, PhysicsType::SOUP>(int x, int y, int index, ChunkTickState& st) {
+    MaterialInstance tile = tiles[index];
+    bool canMoveBelowL = canDisplace(tile, tiles[(x - 1) + (y + 1) * width]);
+    bool canMoveBelowR = canDisplace(tile, tiles[(x + 1) + (y + 1) * width]);
+    if(!(canMoveBelowL || canMoveBelowR)) return;
 
-                                        tiles[(x + 1) + (y + 1) * width] = tile;
-                                        dirty[(x + 1) + (y + 1) * width] = true;
-                                        tickVisited[(x + 1) + (y + 1) * width] = true;
-                                    }
-                                } else if(type == PhysicsType::SOUP) {
-                                    //active[index] = true;
-                                    MaterialInstance belowLTile = tiles[(x - 1) + (y + 1) * width];
-                                    int belowL = belowLTile.mat->physicsType;
-                                    MaterialInstance belowRTile = tiles[(x + 1) + (y + 1) * width];
-                                    int belowR = belowRTile.mat->physicsType;
-
-                                    bool canMoveBelowL = (belowL == PhysicsType::AIR || (belowL != PhysicsType::SOLID && belowLTile.mat->density < tile.mat->density));
-                                    bool canMoveBelowR = (belowR == PhysicsType::AIR || (belowR != PhysicsType::SOLID && belowRTile.mat->density < tile.mat->density));
-
-                                    if(!(canMoveBelowL || canMoveBelowR)) continue;
-
-                                    MaterialInstance lTile = tiles[(x - 1) + (y)* width];
-                                    int l = lTile.mat->physicsType;
-                                    MaterialInstance rTile = tiles[(x + 1) + (y)* width];
-                                    int r = rTile.mat->physicsType;
-
-                                    bool canMoveL = (l == PhysicsType::AIR || (l != PhysicsType::SOLID && lTile.mat->density < tile.mat->density));
-                                    bool canMoveR = (r == PhysicsType::AIR || (r != PhysicsType::SOLID && rTile.mat->density < tile.mat->density));
-
-                                    if(!((canMoveL || canMoveR) && rand() % 10 == 0)) {
-                                        if(canMoveBelowL && !(canMoveBelowR && rand() % 2 == 0)) {
-                                            if(tiles[(x - 1) + y * width].mat->physicsType == PhysicsType::AIR) {
-                                                tiles[(x - 1) + y * width] = belowLTile;
-                                                dirty[(x - 1) + y * width] = true;
-                                                tiles[index] = Tiles::NOTHING;
-                                                dirty[index] = true;
-                                            } else {
-                                                tiles[index] = belowLTile;
-                                                dirty[index] = true;
-                                            }
+    bool canMoveL = canDisplace(tile, tiles[(x - 1) + y * width]);
+    bool canMoveR = canDisplace(tile, tiles[(x + 1) + y * width]);
 
-                                            tiles[(x - 1) + (y + 1) * width] = tile;
-                                            dirty[(x - 1) + (y + 1) * width] = true;
-                                            tickVisited[(x - 1) + (y + 1) * width] = true;
-                                        } else if(canMoveBelowR) {
-                                            if(tiles[(x + 1) + y * width].mat->physicsType == PhysicsType::AIR) {
-                                                tiles[(x + 1) + y * width] = belowRTile;
-                                                dirty[(x + 1) + y * width] = true;
-                                                tiles[index] = Tiles::NOTHING;
-                                                dirty[index] = true;
-                                            } else {
-                                                tiles[index] = belowRTile;
-                                                dirty[index] = true;
-                                            }
+    // now and then leave it to the sideways pass instead
+    if((canMoveL || canMoveR) && st.rng.next() % 10 == 0) return;
 
-                                            tiles[(x + 1) + (y + 1) * width] = tile;
-                                            dirty[(x + 1) + (y + 1) * width] = true;
-                                            tickVisited[(x + 1) + (y + 1) * width] = true;
-                                        }
-                                    }
-                                } else if(type == PhysicsType::GAS) {
-                                    //active[index] = true;
-                                    int aboveL = tiles[(x - 1) + (y - 1) * width].mat->physicsType;
-                                    int aboveR = tiles[(x + 1) + (y - 1) * width].mat->physicsType;
-
-                                    if(aboveL == 0 && !(aboveR == 0 && rand() % 2 == 0)) {
-                                        tiles[index] = tiles[(x - 1) + (y - 1) * width];
-                                        dirty[index] = true;
-
-                                        tiles[(x - 1) + (y - 1) * width] = tile;
-                                        dirty[(x - 1) + (y - 1) * width] = true;
-                                        tickVisited[(x - 1) + (y - 1) * width] = true;
-                                    } else if(aboveR == 0) {
-                                        tiles[index] = tiles[(x + 1) + (y - 1) * width];
-                                        dirty[index] = true;
-
-                                        tiles[(x + 1) + (y - 1) * width] = tile;
-                                        dirty[(x + 1) + (y - 1) * width] = true;
-                                        tickVisited[(x + 1) + (y - 1) * width] = true;
-                                    }
-                                }
-                            }
-                        }
-                        EASY_END_BLOCK;
+    if(canMoveBelowL && !(canMoveBelowR && st.rng.next() % 2 == 0)) {
+        tickSlide(x, y, tile, -1, false, st);
+    } else if(canMoveBelowR) {
+        tickSlide(x, y, tile, 1, false, st);
+    }
+}
 
-                        EASY_BLOCK("iter 3");
-                        for(int dy = CHUNK_H - 1; dy >= 0; dy--) {
-                            int y = cy + dy;
-                            for(int dx = 0; dx < CHUNK_W; dx++) {
-                                int x = cx + dx;
-                                int index = x + y * width;
+template<>
+void World::tickCell<2, PhysicsType::GAS>(int x, int y, int index, ChunkTickState& st) {
+    int aboveL = Materials::PHYSICS_TYPE[tiles[(x - 1) + (y - 1) * width].mat.id];
+    int aboveR = Materials::PHYSICS_TYPE[tiles[(x + 1) + (y - 1) * width].mat.id];
 
-                                if(tickVisited[index]) continue;
+    if(aboveL == PhysicsType::AIR && !(aboveR == PhysicsType::AIR && st.rng.next() % 2 == 0)) {
+        tickSwap(index, (x - 1) + (y - 1) * width, st);
+    } else if(aboveR == PhysicsType::AIR) {
+        tickSwap(index, (x + 1) + (y - 1) * width, st);
+    }
+}
 
-                                MaterialInstance tile = tiles[index];
+template<>
+void World::tickCell<3, PhysicsType::SOUP>(int x, int y, int index, ChunkTickState& st) {
+    MaterialInstance tile = tiles[index];
 
-                                int type = tile.mat->physicsType;
+    if(canDisplace(tile, tiles[(x - 1) + y * width])) {
+        tickSwap(index, (x - 1) + y * width, st);
+    } else if(canDisplace(tile, tiles[(x + 1) + y * width])) {
+        tickSwap(index, (x + 1) + y * width, st);
+    }
+}
 
-                                if(type == PhysicsType::SOUP) {
-                                    //active[index] = true;
+template<>
+void World::tickCell<3, PhysicsType::GAS>(int x, int y, int index, ChunkTickState& st) {
+    int l = Materials::PHYSICS_TYPE[tiles[(x - 1) + y * width].mat.id];
+    int r = Materials::PHYSICS_TYPE[tiles[(x + 1) + y * width].mat.id];
 
-                                    MaterialInstance lTile = tiles[(x - 1) + (y)* width];
-                                    int l = lTile.mat->physicsType;
-                                    MaterialInstance rTile = tiles[(x + 1) + (y)* width];
-                                    int r = rTile.mat->physicsType;
+    if(l == PhysicsType::AIR && !(r == PhysicsType::AIR && st.rng.next() % 2 == 0)) {
+        tickSwap(index, (x - 1) + y * width, st);
+    } else if(r == PhysicsType::AIR) {
+        tickSwap(index, (x + 1) + y * width, st);
+    } else if(tiles[index].mat.id == Materials::STEAM.id) {
+        // stuck steam condenses at random, so it never settles
+        wake(x, y);
+        if(st.rng.next() % 10 == 0) {
+            tiles[index] = Tiles::createWater();
+            markDirty(index);
+        }
+    }
+}
 
-                                    bool canMoveL = (l == PhysicsType::AIR || (l != PhysicsType::SOLID && lTile.mat->density < tile.mat->density));
-                                    bool canMoveR = (r == PhysicsType::AIR || (r != PhysicsType::SOLID && rTile.mat->density < tile.mat->density));
+static inline int lowestBit(uint64_t v) {
+    #if defined(_MSC_VER) && defined(_WIN64)
+    unsigned long i;
+    _BitScanForward64(&i, v);
+    return (int)i;
+    #elif defined(_MSC_VER)
+    unsigned long i;
+    if(_BitScanForward(&i, (unsigned long)v)) return (int)i;
+    _BitScanForward(&i, (unsigned long)(v >> 32));
+    return (int)i + 32;
+    #else
+    return __builtin_ctzll(v);
+    #endif
+}
 
-                                    if(canMoveL && !(canMoveR && rand() % 2 == 5)) {
-                                        tiles[index] = lTile;
-                                        dirty[index] = true;
+static inline int highestBit(uint64_t v) {
+    #if defined(_MSC_VER) && defined(_WIN64)
+    unsigned long i;
+    _BitScanReverse64(&i, v);
+    return (int)i;
+    #elif defined(_MSC_VER)
+    unsigned long i;
+    if(_BitScanReverse(&i, (unsigned long)(v >> 32))) return (int)i + 32;
+    _BitScanReverse(&i, (unsigned long)v);
+    return (int)i;
+    #else
+    return 63 - __builtin_clzll(v);
+    #endif
+}
 
-                                        tiles[(x - 1) + (y)* width] = tile;
-                                        dirty[(x - 1) + (y)* width] = true;
-                                        tickVisited[(x - 1) + (y)* width] = true;
-                                    } else if(canMoveR) {
-                                        tiles[index] = rTile;
-                                        dirty[index] = true;
+// the first set bit of row going from `from` towards `to` (both inclusive), or -1
+template<bool reverseX>
+static inline int nextLiveCell(const uint64_t* row, int from, int to) {
+    if(reverseX ? from < to : from > to) return -1;
+    int w = from >> 6;
+    uint64_t bits = row[w] & (reverseX ? (~0ULL >> (63 - (from & 63))) : (~0ULL << (from & 63)));
+    while(true) {
+        if(bits) {
+            int x = (w << 6) + (reverseX ? highestBit(bits) : lowestBit(bits));
+            return (reverseX ? x >= to : x <= to) ? x : -1;
+        }
+        w += reverseX ? -1 : 1;
+        if(reverseX ? w < (to >> 6) : w > (to >> 6)) return -1;
+        bits = row[w];
+    }
+}
 
-                                        tiles[(x + 1) + (y)* width] = tile;
-                                        dirty[(x + 1) + (y)* width] = true;
-                                        tickVisited[(x + 1) + (y)* width] = true;
-                                    }
-                                } else if(type == PhysicsType::GAS) {
-                                    //active[index] = true;
-
-                                    int l = tiles[(x - 1) + (y)* width].mat->physicsType;
-                                    int r = tiles[(x + 1) + (y)* width].mat->physicsType;
-
-                                    if(l == 0 && !(r == 0 && rand() % 2 == 0)) {
-                                        tiles[index] = getTile(x - 1, y);
-                                        dirty[index] = true;
-
-                                        tiles[(x - 1) + (y)* width] = tile;
-                                        dirty[(x - 1) + (y)* width] = true;
-                                        tickVisited[(x - 1) + (y)* width] = true;
-                                    } else if(r == 0) {
-                                        tiles[index] = getTile(x + 1, y);
-                                        dirty[index] = true;
-
-                                        tiles[(x + 1) + (y)* width] = tile;
-                                        dirty[(x + 1) + (y)* width] = true;
-                                        tickVisited[(x + 1) + (y)* width] = true;
-                                    } else {
-                                        if(tile.mat->id == Materials::STEAM.id) {
-                                            if(rand() % 10 == 0) {
-                                                tiles[index] = Tiles::createWater();
-                                                dirty[index] = true;
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                        EASY_END_BLOCK;
-                        EASY_END_BLOCK;
-                        #ifdef DO_REVERSE
-                    }
-                    #endif
-                    #undef DO_REVERSE
-                    #ifdef DO_MULTITHREADING
-                    return parts;
-                    }));
-                    #endif
-                    EASY_END_BLOCK;
-                }
+template<int pass, bool reverseX>
+void World::tickChunkPass(int cx, int cy, ChunkTickState& st) {
+    for(int dy = CHUNK_H - 1; dy >= 0; dy--) {
+        int y = cy + dy;
+        int rowMinX, rowMaxX;
+        if(!simRowRange(cx, y, &rowMinX, &rowMaxX)) continue;
+        // only visit live cells, the bits are re-read after every cell since the kernel moves things around as it goes
+        const uint64_t* row = liveCells + y * liveCellsStride;
+        for(int x = nextLiveCell<reverseX>(row, reverseX ? rowMaxX : rowMinX, reverseX ? rowMinX : rowMaxX); x != -1; x = nextLiveCell<reverseX>(row, reverseX ? x - 1 : x + 1, reverseX ? rowMinX : rowMaxX)) {
+            int index = x + y * width;
+
+            if(tickVisited[index] == st.visit) continue;
+
+            uint16_t id = tiles[index].mat.id;
+            if(pass == 1 && st.iter >= Materials::ITERATIONS[id]) {
+                // done for this tick, keep the later passes off it too
+                tickVisited[index] = st.visit;
+                continue;
             }
-        EASY_END_BLOCK;
 
-        #ifdef DO_MULTITHREADING
-        EASY_BLOCK("wait for threads", THREAD_WAIT_PROFILER_COLOR);
-        for(int i = 0; i < results.size(); i++) {
-            EASY_BLOCK("get particles");
-            std::vector<Particle*> pts = results[i].get();
-            EASY_END_BLOCK;
-            EASY_BLOCK("insert particles");
-            particles.insert(particles.end(), pts.begin(), pts.end());
-            EASY_END_BLOCK;
+            switch(Materials::PHYSICS_TYPE[id]) {
+            case PhysicsType::SAND:
+                tickCell<pass, PhysicsType::SAND>(x, y, index, st);
+                break;
+            case PhysicsType::SOUP:
+                tickCell<pass, PhysicsType::SOUP>(x, y, index, st);
+                break;
+            case PhysicsType::GAS:
+                tickCell<pass, PhysicsType::GAS>(x, y, index, st);
+                break;
+            case PhysicsType::PASSABLE:
+                tickCell<pass, PhysicsType::PASSABLE>(x, y, index, st);
+                break;
+            }
         }
-        EASY_END_BLOCK;
-        #endif
+    }
+}
+
+template<bool reverseX>
+void World::tickChunk(int cx, int cy, ChunkTickState& st) {
+    EASY_BLOCK("chunk");
+    EASY_BLOCK("iter 1");
+    tickChunkPass<1, reverseX>(cx, cy, st);
+    EASY_END_BLOCK;
+    EASY_BLOCK("iter 2");
+    tickChunkPass<2, reverseX>(cx, cy, st);
+    EASY_END_BLOCK;
+    EASY_BLOCK("iter 3");
+    tickChunkPass<3, reverseX>(cx, cy, st);
+    EASY_END_BLOCK;
+    EASY_END_BLOCK;
+}
 
-        #undef DO_MULTITHREADING
+// which of the 4 checkerboard phases chunk (i, j) of the tick zone runs in
+static inline int tickPhase(int i, int j) {
+    return (i % 2) + 2 * (1 - j % 2);
+}
 
-        //while (tickPool->n_idle() != tickPool->size()) {
-        //	//printf("%d / %d", tickPool->n_idle(), tickPool->size());
-        //	auto n = tickPool->n_idle();
-        //	auto i = 0;
-        //}
+void World::tick() {
+    EASY_FUNCTION(WORLD_PROFILER_COLOR);
+
+    tickChunks();
+    tickCells();
+    tickPhysicsCheck();
+}
+
+// only touches tiles, the sim state and particles, so Game can run it off the main thread (see Game::finishTick)
+void World::tickCells() {
+    EASY_FUNCTION(WORLD_PROFILER_COLOR);
+
+    // pick up changes made outside of the tick, then let quiet sim tiles fall asleep
+    EASY_BLOCK("sim tiles");
+    wakeDirty();
+    sleepSimTiles();
+    commitSimTiles();
+    EASY_END_BLOCK;
+
+    // every chunk of the tick zone runs once per iteration, in the checkerboard phase of its position
+    // neighbouring chunks never share a phase, so the only ordering that matters is between neighbours:
+    // a chunk's phase waits for the previous phases of itself and its 8 neighbours instead of for the whole world
+    EASY_BLOCK("build task graph");
+    int chunksX = (tickZone.w + CHUNK_W - 1) / CHUNK_W;
+    int chunksY = (tickZone.h + CHUNK_H - 1) / CHUNK_H;
+    int chunksPerIter = chunksX * chunksY;
+
+    // each of the 16 phases gets its own stamp, see tickVisitStamp
+    if(tickVisitStamp > UINT16_MAX - 16) {
+        EASY_BLOCK("memset");
+        memset(tickVisited, 0, width * height * sizeof(uint16_t));
         EASY_END_BLOCK;
+        tickVisitStamp = 0;
+    }
+    uint16_t firstVisit = tickVisitStamp + 1;
+    tickVisitStamp += 16;
+
+    // the buffers live on between ticks, so after the first few ticks emitting a particle doesn't allocate
+    if(tickEmitted.size() != 4 * chunksPerIter) tickEmitted.resize(4 * chunksPerIter);
+
+    for(int iter = 0; iter < 4; iter++) {
+        bool reverseX = (tickCt + iter) % 2 == 0;
+        for(int j = 0; j < chunksY; j++) {
+            for(int i = 0; i < chunksX; i++) {
+                int cx = tickZone.x + i * CHUNK_W;
+                int cy = tickZone.y + j * CHUNK_H;
+                int phase = iter * 4 + tickPhase(i, j);
+                int task = i + j * chunksX + iter * chunksPerIter;
+                tickScheduler->addTask([&, cx, cy, iter, phase, reverseX, task](int worker) {
+                    EASY_BLOCK("chunk task");
+                    // cells that moved last iteration get scanned in this one
+                    if(iter > 0) commitSimTiles(cx, cy);
+                    if(!simChunkAwake(cx, cy)) return;
+
+                    // seeded from the chunk's position in the world and the phase, so a replay with the same seed rolls the same numbers
+                    ChunkTickState st(iter, firstVisit + phase, Random(seed, (cx - loadZone.x) / CHUNK_W, (cy - loadZone.y) / CHUNK_H, (uint32_t)(tickCt * 16 + phase)), tickEmitted[task]);
+                    if(reverseX) {
+                        tickChunk<true>(cx, cy, st);
+                    } else {
+                        tickChunk<false>(cx, cy, st);
+                    }
+                });
+            }
+        }
+    }
+
+    // tasks were added in order, so the id of a task is its index in tickEmitted
+    for(int iter = 0; iter < 4; iter++) {
+        for(int j = 0; j < chunksY; j++) {
+            for(int i = 0; i < chunksX; i++) {
+                int task = i + j * chunksX + iter * chunksPerIter;
+                int phase = tickPhase(i, j);
+                for(int nj = j - 1; nj <= j + 1; nj++) {
+                    for(int ni = i - 1; ni <= i + 1; ni++) {
+                        if(ni < 0 || nj < 0 || ni >= chunksX || nj >= chunksY) continue;
+                        // the neighbour's last phase before ours: earlier in this iteration, or else in the previous one
+                        int before = ni + nj * chunksX + iter * chunksPerIter;
+                        if(tickPhase(ni, nj) >= phase) before -= chunksPerIter;
+                        if(before >= 0) tickScheduler->addDependency(before, task);
+                    }
+                }
+            }
         }
+    }
+    EASY_END_BLOCK;
+
+    EASY_BLOCK("run task graph", THREAD_WAIT_PROFILER_COLOR);
+    tickScheduler->run();
+    EASY_END_BLOCK;
 
+    // one splice per tick, in task order so it doesn't matter which worker ran what
+    EASY_BLOCK("insert particles");
+    for(auto& pts : tickEmitted) {
+        for(auto& p : pts) addParticle(p);
+        pts.clear();
     }
+    EASY_END_BLOCK;
+
+    tickCt++;
+}
 
-#undef DO_MULTITHREADING
-tickCt++;
+void World::tickPhysicsCheck() {
+EASY_FUNCTION(WORLD_PROFILER_COLOR);
 
 EASY_BLOCK("do physicsChecks");
+Random rng(seed, INT32_MIN, INT32_MIN, (uint32_t)tickCt);
 for(int i = 0; i < 1; i++) {
-    int randX = rand() % tickZone.w;
-    int randY = rand() % tickZone.h;
+    int randX = rng.next() % tickZone.w;
+    int randY = rng.next() % tickZone.h;
     //setTile(tickZone.x + randX, tickZone.y + randY, MaterialInstance(&Materials::GENERIC_SOLID, 0x00ff00ff));
     physicsCheck(tickZone.x + randX, tickZone.y + randY);
 }
@@ -2335,7 +1941,7 @@ active = new bool[width * height];*/
 /*std::fill(light, light + width * height, 0);
 for (int x = 0; x < width; x++) {
     for (int y = 0; y < height; y++) {
-        if (tiles[x + y * width].mat->physicsType == PhysicsType::AIR) {
+        if (Materials::PHYSICS_TYPE[tiles[x + y * width].mat.id] == PhysicsType::AIR) {
             applyLightRec(x, y, 1);
         }
     }
@@ -2343,255 +1949,413 @@ for (int x = 0; x < width; x++) {
 
 }
 
+void World::gatherTemperatureRow(int y, int minX, int maxX) {
+    for(int x = minX; x <= maxX; x++) {
+        int i = x + y * width;
+        uint16_t id = tiles[i].mat.id;
+        tempPlane[i] = tiles[i].temperature;
+        conductionPlane[i] = Materials::CONDUCTION_OTHER[id];
+        conductionSelfPlane[i] = Materials::CONDUCTION_SELF[id];
+        addTempPlane[i] = Materials::ADD_TEMP[id];
+        reactBelowPlane[i] = Materials::REACT_BELOW[id];
+        reactAbovePlane[i] = Materials::REACT_ABOVE[id];
+    }
+}
+
+bool World::commitTemperatureRow(int y, int minX, int maxX, std::vector<int>& reactions) {
+    bool warm = false;
+    int changedMinX = INT_MAX;
+    int changedMaxX = INT_MIN;
+    for(int x = minX; x <= maxX; x++) {
+        // tiles only hold 16 bit temperatures
+        int32_t temp = newTemps[x + y * width];
+        if(temp > INT16_MAX) temp = INT16_MAX;
+        if(temp < INT16_MIN) temp = INT16_MIN;
+        if(temp != 0) warm = true;
+        newTemps[x + y * width] = temp;
+
+        MaterialInstance& tile = tiles[x + y * width];
+        if(tile.temperature == temp) continue;
+        tile.temperature = (int16_t)temp;
+        if(x < changedMinX) changedMinX = x;
+        changedMaxX = x;
+    }
+
+    // whatever changed and its neighbours get another pass
+    if(changedMinX <= changedMaxX) heatArea(changedMinX - 1, y - 1, changedMaxX + 1, y + 1);
+
+    int i = minX + y * width;
+    Temperature::findReactions(&newTemps[i], &reactBelowPlane[i], &reactAbovePlane[i], maxX - minX + 1, i, reactions);
+    return warm;
+}
+
+void World::applyReactions(int index) {
+    MaterialInstance tile = tiles[index];
+    for(uint32_t i = Materials::REACTION_START[tile.mat.id]; i < Materials::REACTION_START[tile.mat.id + 1]; i++) {
+        const MaterialInteraction& in = Materials::REACTIONS[i];
+        if((in.type == REACT_TEMPERATURE_BELOW && tile.temperature < in.data1) || (in.type == REACT_TEMPERATURE_ABOVE && tile.temperature > in.data1)) {
+            tiles[index] = Tiles::create(Materials::MATERIALS[in.data2], index % width, index / width);
+            tiles[index].temperature = tile.temperature;
+            markDirty(index);
+        }
+    }
+}
+
+bool World::simTileWarm(int tx, int ty) {
+    for(int y = ty * SIM_TILE_H; y < std::min(height, (ty + 1) * SIM_TILE_H); y++) {
+        for(int x = tx * SIM_TILE_W; x < std::min(width, (tx + 1) * SIM_TILE_W); x++) {
+            if(tiles[x + y * width].temperature != 0) return true;
+        }
+    }
+    return false;
+}
+
 void World::tickTemperature() {
-    // TODO: multithread
     EASY_FUNCTION(WORLD_PROFILER_COLOR);
 
-    EASY_BLOCK("iterate");
-    for(int y = (tickZone.y + tickZone.h) - 1; y >= tickZone.y; y--) {
-        for(int x = tickZone.x; x < (tickZone.x + tickZone.w); x++) {
-            float n = 0.01;
-            float v = 0;
-            //for (int xx = -1; xx <= 1; xx++) {
-            //	for (int yy = -1; yy <= 1; yy++) {
-            //		float factor = abs(tiles[(x + xx) + (y + yy) * width].temperature) / 64 * tiles[(x + xx) + (y + yy) * width].mat->conductionOther;
-            //		//factor = fmax(-1, fmin(factor, 1));
-
-            //		v += tiles[(x + xx) + (y + yy) * width].temperature * factor;
-            //		n += factor;
-
-            //		// ((v1 * f1) + (v2 * f2)) / (f1 + f2)
-            //		//=(v1 * f1) + (v2 * f2)
-            //	}
-            //}
-            float factor = 0;
-            #define FN(xa, ya) \
-if(tiles[(x + xa) + (y + ya) * width].temperature != 0){\
-factor = abs(tiles[(x + xa) + (y + ya) * width].temperature) / 64 * tiles[(x + xa) + (y + ya) * width].mat->conductionOther; \
-v += tiles[(x + xa) + (y + ya) * width].temperature * factor; \
-n += factor;\
-}
-
-            if(tiles[(x + -1) + (y + -1) * width].temperature) {
-                factor = abs(tiles[(x + -1) + (y + -1) * width].temperature) / 64 * tiles[(x + -1) + (y + -1) * width].mat->conductionOther;
-                v += tiles[(x + -1) + (y + -1) * width].temperature * factor;
-                n += factor;
-            }
-            if(tiles[(x + -1) + (y + 0) * width].temperature) {
-                factor = abs(tiles[(x + -1) + (y + 0) * width].temperature) / 64 * tiles[(x + -1) + (y + 0) * width].mat->conductionOther;
-                v += tiles[(x + -1) + (y + 0) * width].temperature * factor;
-                n += factor;
-            }
-            if(tiles[(x + -1) + (y + 1) * width].temperature) {
-                factor = abs(tiles[(x + -1) + (y + 1) * width].temperature) / 64 * tiles[(x + -1) + (y + 1) * width].mat->conductionOther;
-                v += tiles[(x + -1) + (y + 1) * width].temperature * factor;
-                n += factor;
-            }
-            if(tiles[(x + 0) + (y + -1) * width].temperature) {
-                factor = abs(tiles[(x + 0) + (y + -1) * width].temperature) / 64 * tiles[(x + 0) + (y + -1) * width].mat->conductionOther;
-                v += tiles[(x + 0) + (y + -1) * width].temperature * factor;
-                n += factor;
-            }
-            if(tiles[(x + 0) + (y + 0) * width].temperature) {
-                factor = abs(tiles[(x + 0) + (y + 0) * width].temperature) / 64 * tiles[(x + 0) + (y + 0) * width].mat->conductionOther;
-                v += tiles[(x + 0) + (y + 0) * width].temperature * factor;
-                n += factor;
-            }
-            if(tiles[(x + 0) + (y + 1) * width].temperature) {
-                factor = abs(tiles[(x + 0) + (y + 1) * width].temperature) / 64 * tiles[(x + 0) + (y + 1) * width].mat->conductionOther;
-                v += tiles[(x + 0) + (y + 1) * width].temperature * factor;
-                n += factor;
-            }
-            if(tiles[(x + 1) + (y + -1) * width].temperature) {
-                factor = abs(tiles[(x + 1) + (y + -1) * width].temperature) / 64 * tiles[(x + 1) + (y + -1) * width].mat->conductionOther;
-                v += tiles[(x + 1) + (y + -1) * width].temperature * factor;
-                n += factor;
+    // only the cells woken since the last pass can change, the rest of the world is skipped
+    // sim tiles outside of the tick zone keep their wakes until it moves over them
+    EASY_BLOCK("collect heat");
+    int firstBand = tickZone.y / TEMPERATURE_BAND_H;
+    int nBands = (tickZone.y + tickZone.h - 1) / TEMPERATURE_BAND_H - firstBand + 1;
+    std::vector<std::vector<int>> bandTiles(nBands);
+    std::vector<std::vector<int>> bandReactions(nBands);
+    int endX = tickZone.x + tickZone.w;
+    int endY = tickZone.y + tickZone.h;
+    for(int ty = tickZone.y / SIM_TILE_H; ty < endY / SIM_TILE_H; ty++) {
+        for(int tx = tickZone.x / SIM_TILE_W; tx < endX / SIM_TILE_W; tx++) {
+            SimTile& t = simTiles[tx + ty * simTilesW];
+            t.heat = t.heatWake;
+            t.heatWake.clear();
+            if(t.heat.empty()) continue;
+
+            // wakes spill one cell past the changes, which may be outside the tick zone
+            t.heat.minX = std::max(t.heat.minX, tickZone.x);
+            t.heat.minY = std::max(t.heat.minY, tickZone.y);
+            t.heat.maxX = std::min(t.heat.maxX, endX - 1);
+            t.heat.maxY = std::min(t.heat.maxY, endY - 1);
+            t.warm = false;
+            bandTiles[ty * SIM_TILE_H / TEMPERATURE_BAND_H - firstBand].push_back(tx + ty * simTilesW);
+        }
+    }
+    EASY_END_BLOCK;
+
+    // bands are made of whole sim tile rows, so wakes from different bands never touch the same sim tile
+    // a band reads the row above and below it, and only writes back rows nobody else reads:
+    // its first and last row wait until every band is done, waking those may touch the neighbouring band's sim tiles too
+    auto bandMinY = [&](int b) { return std::max(tickZone.y, (firstBand + b) * TEMPERATURE_BAND_H); };
+    auto bandMaxY = [&](int b) { return std::min(endY, (firstBand + b + 1) * TEMPERATURE_BAND_H) - 1; };
+
+    // the planes of a band's edge rows and the rows past them are read by two bands, so they're gathered here first
+    // the bands only gather the rows in between, which no other band reads
+    EASY_BLOCK("gather band edges");
+    for(int b = 0; b < nBands; b++) {
+        for(int i : bandTiles[b]) {
+            SimRect& r = simTiles[i].heat;
+            for(int y = r.minY - 1; y <= r.maxY + 1; y++) {
+                if(y <= bandMinY(b) || y >= bandMaxY(b)) gatherTemperatureRow(y, r.minX - 1, r.maxX + 1);
             }
-            if(tiles[(x + 1) + (y + 0) * width].temperature) {
-                factor = abs(tiles[(x + 1) + (y + 0) * width].temperature) / 64 * tiles[(x + 1) + (y + 0) * width].mat->conductionOther;
-                v += tiles[(x + 1) + (y + 0) * width].temperature * factor;
-                n += factor;
+        }
+    }
+    EASY_END_BLOCK;
+
+    EASY_BLOCK("iterate");
+    for(int b = 0; b < nBands; b++) {
+        if(bandTiles[b].empty()) continue;
+        tickScheduler->addTask([&, b](int worker) {
+            // gather everything first, the rects read each other's cells
+            for(int i : bandTiles[b]) {
+                SimRect& r = simTiles[i].heat;
+                for(int y = std::max(r.minY - 1, bandMinY(b) + 1); y <= std::min(r.maxY + 1, bandMaxY(b) - 1); y++) gatherTemperatureRow(y, r.minX - 1, r.maxX + 1);
             }
-            if(tiles[(x + 1) + (y + 1) * width].temperature) {
-                factor = abs(tiles[(x + 1) + (y + 1) * width].temperature) / 64 * tiles[(x + 1) + (y + 1) * width].mat->conductionOther;
-                v += tiles[(x + 1) + (y + 1) * width].temperature * factor;
-                n += factor;
+            for(int i : bandTiles[b]) {
+                SimRect& r = simTiles[i].heat;
+                for(int y = r.minY; y <= r.maxY; y++) {
+                    int j = r.minX + y * width;
+                    Temperature::diffuseRow(&tempPlane[j], &conductionPlane[j], width, &conductionSelfPlane[j], &addTempPlane[j], &newTemps[j], r.maxX - r.minX + 1);
+                }
             }
-            //FN(-1, -1);
-            //FN(-1, 0);
-            //FN(-1, 1);
-            //FN(0, -1);
-            //FN(0, 0);
-            //FN(0, 1);
-            //FN(1, -1);
-            //FN(1, 0);
-            //FN(1, 1);
-            #undef FN
-
-            if(v != 0) {
-                newTemps[x + y * width] = tiles[x + y * width].mat->addTemp + (v / n * tiles[x + y * width].mat->conductionSelf) + (tiles[x + y * width].temperature * (1 - tiles[x + y * width].mat->conductionSelf));
-            } else {
-                newTemps[x + y * width] = tiles[x + y * width].mat->addTemp + tiles[x + y * width].temperature;
+            for(int i : bandTiles[b]) {
+                SimTile& t = simTiles[i];
+                for(int y = t.heat.minY; y <= t.heat.maxY; y++) {
+                    if(y == bandMinY(b) || y == bandMaxY(b)) continue;
+                    if(commitTemperatureRow(y, t.heat.minX, t.heat.maxX, bandReactions[b])) t.warm = true;
+                }
             }
-        }
+        });
     }
+    tickScheduler->run();
     EASY_END_BLOCK; // iterate
-    EASY_BLOCK("copy");
-    for(int y = (tickZone.y + tickZone.h) - 1; y >= tickZone.y; y--) {
-        for(int x = tickZone.x; x < (tickZone.x + tickZone.w); x++) {
-            tiles[x + y * width].temperature = newTemps[x + y * width];
+
+    EASY_BLOCK("commit band edges");
+    for(int b = 0; b < nBands; b++) {
+        for(int i : bandTiles[b]) {
+            SimTile& t = simTiles[i];
+            int y0 = bandMinY(b);
+            int y1 = bandMaxY(b);
+            if(y0 >= t.heat.minY && y0 <= t.heat.maxY && commitTemperatureRow(y0, t.heat.minX, t.heat.maxX, bandReactions[b])) t.warm = true;
+            if(y1 != y0 && y1 >= t.heat.minY && y1 <= t.heat.maxY && commitTemperatureRow(y1, t.heat.minX, t.heat.maxX, bandReactions[b])) t.warm = true;
+
+            // the pass only saw part of the tile, the rest may still be holding on to some heat
+            if(!t.warm) t.warm = simTileWarm(i % simTilesW, i / simTilesW);
         }
     }
-    EASY_END_BLOCK; // copy
+    EASY_END_BLOCK; // commit band edges
+
+    // the few cells that react change material, which wakes things across bands, so that happens here
+    EASY_BLOCK("reactions");
+    for(auto& cells : bandReactions) {
+        for(int index : cells) applyReactions(index);
+    }
+    EASY_END_BLOCK; // reactions
 }
 
 void World::renderParticles(unsigned char** texture) {
     EASY_FUNCTION(WORLD_PROFILER_COLOR);
 
-    for(auto& cur : particles) {
-        if(cur->x < 0 || cur->x >= width || cur->y < 0 || cur->y >= height) continue;
+    int first = INT_MAX;
+    int last = -1;
+    for(unsigned int offset : particlePixels) {
+        memset(&(*texture)[offset], 0, 4);
+        first = std::min(first, (int)offset / 4);
+        last = std::max(last, (int)offset / 4);
+    }
+    particlePixels.clear();
+
+    for(int i = 0; i < particles.size(); i++) {
+        float px = particles.x[i];
+        float py = particles.y[i];
+        if(px < 0 || px >= width || py < 0 || py >= height) continue;
 
         float alphaMod = 1;
-        if(cur->temporary) {
-            if(cur->lifetime < cur->fadeTime) {
-                alphaMod = (cur->lifetime / (float)cur->fadeTime);
+        if(particles.temporary[i]) {
+            if(particles.lifetime[i] < particles.fadeTime[i]) {
+                alphaMod = (particles.lifetime[i] / (float)particles.fadeTime[i]);
             }
         }
         //float alphaMod = 1;
-        EASY_BLOCK("particle render");
-        const unsigned int offset = (width * 4 * (int)cur->y) + (int)cur->x * 4;
-        Uint32 color = cur->tile.color;
+        const unsigned int offset = (width * 4 * (int)py) + (int)px * 4;
+        Uint32 color = particles.tile[i].color;
         (*texture)[offset + 2] = (color >> 0) & 0xff;        // b
         (*texture)[offset + 1] = (color >> 8) & 0xff;        // g
         (*texture)[offset + 0] = (color >> 16) & 0xff;        // r
-        (*texture)[offset + 3] = (Uint8)(cur->tile.mat->alpha * alphaMod);    // a
-        //SDL_SetRenderDrawColor(renderer, (cur->tile.color >> 16) & 0xff, (cur->tile.color >> 8) & 0xff, (cur->tile.color >> 0) & 0xff, (Uint8)(cur->tile.mat->alpha * alphaMod));
-        //SDL_RenderDrawPoint(renderer, (int)cur->x, (int)cur->y);
-        EASY_END_BLOCK;
+        (*texture)[offset + 3] = (Uint8)(Materials::ALPHA[particles.tile[i].mat.id] * alphaMod);    // a
+        particlePixels.push_back(offset);
+        first = std::min(first, (int)offset / 4);
+        last = std::max(last, (int)offset / 4);
     }
+
+    particleDirtyFirst = last < 0 ? -1 : first;
+    particleDirtyLast = last;
 }
 
-void World::tickParticles() {
-    EASY_FUNCTION(WORLD_PROFILER_COLOR);
+bool World::tickParticle(int i, std::vector<ParticleDeposit>& deposits) {
+    ParticleStore& p = particles;
 
-    /*SDL_Rect* fr = new SDL_Rect{ 0, 0, width, height };
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
-    SDL_RenderClear(renderer);
-    delete fr;*/
+    if(p.temporary[i] && p.lifetime[i] <= 0) return true;
 
-    particles.erase(std::remove_if(particles.begin(), particles.end(), [&](Particle* cur) {
-        EASY_BLOCK("particle tick");
+    if(p.targetForce[i] != 0) {
+        float tdx = p.targetX[i] - p.x[i];
+        float tdy = p.targetY[i] - p.y[i];
+        float normFac = sqrtf(tdx * tdx + tdy * tdy);
 
-        if(cur->temporary && cur->lifetime <= 0) {
-            cur->killCallback();
-            delete cur;
-            return true;
+        p.vx[i] += tdx / normFac * p.targetForce[i];
+        p.vy[i] += tdy / normFac * p.targetForce[i];
+
+        if(normFac < 100) {
+            p.vx[i] *= 0.95f;
+            p.vy[i] *= 0.95f;
         }
 
-        if(cur->targetForce != 0) {
-            float tdx = cur->targetX - cur->x;
-            float tdy = cur->targetY - cur->y;
-            float normFac = sqrtf(tdx * tdx + tdy * tdy);
+    }
 
-            cur->vx += tdx / normFac * cur->targetForce;
-            cur->vy += tdy / normFac * cur->targetForce;
+    int lx = p.x[i];
+    int ly = p.y[i];
 
-            if(normFac < 100) {
-                cur->vx *= 0.95f;
-                cur->vy *= 0.95f;
-            }
+    if((p.x[i] < 0 || (int)(p.x[i]) >= width || p.y[i] < 0 || (int)(p.y[i]) >= height)) return true;
 
-        }
+    if(!(lx >= tickZone.x && ly >= tickZone.y && lx < tickZone.x + tickZone.w && ly < tickZone.y + tickZone.h)) return false;
 
-        int lx = cur->x;
-        int ly = cur->y;
+    p.vx[i] += p.ax[i];
+    p.vy[i] += p.ay[i];
 
-        if((cur->x < 0 || (int)(cur->x) >= width || cur->y < 0 || (int)(cur->y) >= height)) {
-            cur->killCallback();
+    int div = (int)((abs(p.vx[i]) + abs(p.vy[i])) + 1);
+
+    float dvx = p.vx[i] / div;
+    float dvy = p.vy[i] / div;
+
+    for(int d = 0; d < div; d++) {
+        p.x[i] += dvx;
+        p.y[i] += dvy;
+
+        if((p.x[i] < 0 || (int)(p.x[i]) >= width || p.y[i] < 0 || (int)(p.y[i]) >= height)) return true;
+
+        int cx = (int)(p.x[i]);
+        int cy = (int)(p.y[i]);
+        if(!p.phase[i] && Materials::PHYSICS_TYPE[tiles[cx + cy * width].mat.id] != PhysicsType::AIR && Materials::PHYSICS_TYPE[tiles[cx + cy * width].mat.id] != PhysicsType::OBJECT) {
+            if(!p.temporary[i]) deposits.push_back({p.tile[i], lx, ly, p.x[i], p.y[i]});
             return true;
         }
+    }
 
-        if(!(lx >= tickZone.x && ly >= tickZone.y && lx < tickZone.x + tickZone.w && ly < tickZone.y + tickZone.h)) return false;
-
-        cur->vx += cur->ax;
-        cur->vy += cur->ay;
+    if(p.lifetime[i] > 0) {
+        p.lifetime[i]--;
+    }
 
-        int div = (int)((abs(cur->vx) + abs(cur->vy)) + 1);
+    return false;
+}
 
-        float dvx = cur->vx / div;
-        float dvy = cur->vy / div;
+// the step at which the spiral search around a deposit reaches each cell of its window, -1 if it never does
+// the search takes the first air cell it reaches, so the lowest step wins
+static std::vector<int> depositSpiralOrder() {
+    int X = DEPOSIT_RADIUS * 2;
+    int Y = DEPOSIT_RADIUS * 2;
+    std::vector<int> order((X + 1) * (Y + 1), -1);
+    int x = 0, y = 0, dx = 0, dy = -1;
+    int t = max(X, Y);
+    int maxI = t * t;
 
-        for(int i = 0; i < div; i++) {
-            cur->x += dvx;
-            cur->y += dvy;
+    for(int s = 0; s < maxI; s++) {
+        if((-X / 2 <= x) && (x <= X / 2) && (-Y / 2 <= y) && (y <= Y / 2)) {
+            order[(x + X / 2) + (y + Y / 2) * (X + 1)] = s;
+        }
 
-            if((cur->x < 0 || (int)(cur->x) >= width || cur->y < 0 || (int)(cur->y) >= height)) {
-                cur->killCallback();
-                return true;
-            }
+        if((x == y) || ((x < 0) && (x == -y)) || ((x > 0) && (x == 1 - y))) {
+            t = dx; dx = -dy; dy = t;
+        }
+        x += dx; y += dy;
+    }
+    return order;
+}
 
-            if(!cur->phase && tiles[(int)(cur->x) + (int)(cur->y) * width].mat->physicsType != PhysicsType::AIR && tiles[(int)(cur->x) + (int)(cur->y) * width].mat->physicsType != PhysicsType::OBJECT) {
-                if(cur->temporary) {
-                    cur->killCallback();
-                    delete cur;
-                    return true;
+bool World::depositBlockHasAir(int bx, int by) {
+    Uint8& air = depositAir[bx + by * depositAirW];
+    if(air == 0) {
+        air = 2;
+        int maxX = std::min((int)width, (bx + 1) * DEPOSIT_BLOCK);
+        int maxY = std::min((int)height, (by + 1) * DEPOSIT_BLOCK);
+        for(int y = by * DEPOSIT_BLOCK; y < maxY && air == 2; y++) {
+            for(int x = bx * DEPOSIT_BLOCK; x < maxX; x++) {
+                if(Materials::PHYSICS_TYPE[tiles[x + y * width].mat.id] == PhysicsType::AIR) {
+                    air = 1;
+                    break;
                 }
+            }
+        }
+        depositAirTouched.push_back(bx + by * depositAirW);
+    }
+    return air == 1;
+}
 
-                if(tiles[(int)(lx)+(int)(ly)* width].mat->physicsType != PhysicsType::AIR) {
-                    /*for (int y = 0; y < 40; y++) {
-                        if (tiles[(int)(cur->x) + (int)(cur->y - y) * width].mat->physicsType == PhysicsType::AIR) {
-                            tiles[(int)(cur->x) + (int)(cur->y - y) * width] = cur->tile;
-                            dirty[(int)(cur->x) + (int)(cur->y - y) * width] = true;
-                            break;
-                        }
-                    }*/
-
-                    {
-                        //printf("=========");
-                        int X = 20;
-                        int Y = 20;
-                        int x = 0, y = 0, dx = 0, dy = -1;
-                        int t = max(X, Y);
-                        int maxI = t * t;
-
-                        for(int i = 0; i < maxI; i++) {
-                            if((-X / 2 <= x) && (x <= X / 2) && (-Y / 2 <= y) && (y <= Y / 2)) {
-                                //printf("%d, %d", x, y);
-                                //DO STUFF
-                                if(tiles[(int)(cur->x + x) + (int)(cur->y + y) * width].mat->physicsType == PhysicsType::AIR) {
-                                    tiles[(int)(cur->x + x) + (int)(cur->y + y) * width] = cur->tile;
-                                    dirty[(int)(cur->x + x) + (int)(cur->y + y) * width] = true;
-                                    break;
-                                }
-                            }
+void World::resetDepositAir() {
+    for(int i : depositAirTouched) depositAir[i] = 0;
+    depositAirTouched.clear();
+}
 
-                            if((x == y) || ((x < 0) && (x == -y)) || ((x > 0) && (x == 1 - y))) {
-                                t = dx; dx = -dy; dy = t;
-                            }
-                            x += dx; y += dy;
-                        }
-                    }
+void World::depositParticle(const ParticleDeposit& d) {
+    // an earlier deposit of the same tick may have filled the cell the particle came from
+    if(Materials::PHYSICS_TYPE[tiles[d.lx + d.ly * width].mat.id] == PhysicsType::AIR) {
+        tiles[d.lx + d.ly * width] = d.tile;
+        markDirty(d.lx + d.ly * width);
+        depositAir[d.lx / DEPOSIT_BLOCK + d.ly / DEPOSIT_BLOCK * depositAirW] = 0;
+        return;
+    }
 
-                    cur->killCallback();
-                    delete cur;
-                    return true;
-                } else {
-                    tiles[(int)(lx)+(int)(ly)* width] = cur->tile;
-                    dirty[(int)(lx)+(int)(ly)* width] = true;
-                    cur->killCallback();
-                    delete cur;
-                    return true;
+    // the first air cell a spiral around where it hit would reach
+    // dense piles have no air anywhere near, so only look inside blocks known to have some
+    static const std::vector<int> order = depositSpiralOrder();
+    const int side = DEPOSIT_RADIUS * 2 + 1;
+    int cx = (int)d.x;
+    int cy = (int)d.y;
+    int minX = std::max(0, cx - DEPOSIT_RADIUS);
+    int minY = std::max(0, cy - DEPOSIT_RADIUS);
+    int maxX = std::min(width - 1, cx + DEPOSIT_RADIUS);
+    int maxY = std::min(height - 1, cy + DEPOSIT_RADIUS);
+
+    int best = -1;
+    int bestOrder = INT_MAX;
+    for(int by = minY / DEPOSIT_BLOCK; by <= maxY / DEPOSIT_BLOCK; by++) {
+        for(int bx = minX / DEPOSIT_BLOCK; bx <= maxX / DEPOSIT_BLOCK; bx++) {
+            if(!depositBlockHasAir(bx, by)) continue;
+
+            int y1 = std::min(maxY, (by + 1) * DEPOSIT_BLOCK - 1);
+            int x1 = std::min(maxX, (bx + 1) * DEPOSIT_BLOCK - 1);
+            for(int y = std::max(minY, by * DEPOSIT_BLOCK); y <= y1; y++) {
+                for(int x = std::max(minX, bx * DEPOSIT_BLOCK); x <= x1; x++) {
+                    int o = order[(x - cx + DEPOSIT_RADIUS) + (y - cy + DEPOSIT_RADIUS) * side];
+                    if(o < 0 || o >= bestOrder) continue;
+                    if(Materials::PHYSICS_TYPE[tiles[x + y * width].mat.id] != PhysicsType::AIR) continue;
+                    best = x + y * width;
+                    bestOrder = o;
                 }
             }
         }
+    }
 
-        if(cur->lifetime > 0) {
-            cur->lifetime--;
-        }
+    if(best >= 0) {
+        tiles[best] = d.tile;
+        markDirty(best);
+        depositAir[(best % width) / DEPOSIT_BLOCK + (best / width) / DEPOSIT_BLOCK * depositAirW] = 0;
+    }
+}
 
-        EASY_END_BLOCK;
-        return false;
-    }), particles.end());
+void World::tickParticles() {
+    EASY_FUNCTION(WORLD_PROFILER_COLOR);
+
+    /*SDL_Rect* fr = new SDL_Rect{ 0, 0, width, height };
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+    delete fr;*/
+
+    // batches only move their own particles and read the tiles,
+    // everything that lands is written into the tiles afterwards, in particle order
+    int nBatches = (particles.size() + PARTICLE_BATCH - 1) / PARTICLE_BATCH;
+    std::vector<std::vector<ParticleDeposit>> batchDeposits(nBatches);
+    std::vector<std::vector<int>> batchDead(nBatches);
+
+    EASY_BLOCK("move");
+    for(int b = 0; b < nBatches; b++) {
+        tickScheduler->addTask([&, b](int worker) {
+            int end = std::min(particles.size(), (b + 1) * PARTICLE_BATCH);
+            for(int i = b * PARTICLE_BATCH; i < end; i++) {
+                if(tickParticle(i, batchDeposits[b])) batchDead[b].push_back(i);
+            }
+        });
+    }
+    tickScheduler->run();
+    EASY_END_BLOCK; // move
+
+    EASY_BLOCK("deposit");
+    for(ParticleDeposit& d : pendingDeposits) depositParticle(d);
+    pendingDeposits.clear();
+    for(int b = 0; b < nBatches; b++) {
+        for(ParticleDeposit& d : batchDeposits[b]) depositParticle(d);
+    }
+    resetDepositAir();
+    EASY_END_BLOCK; // deposit
+
+    // highest slot first, so the last particle moved into a freed slot is always a live one
+    for(int b = nBatches - 1; b >= 0; b--) {
+        for(int j = (int)batchDead[b].size() - 1; j >= 0; j--) particles.remove(batchDead[b][j]);
+    }
+
+    // past half the budget, temporary particles of one material in the same cell are shown as one
+    if(particles.size() > Settings::particle_budget / 2) {
+        EASY_BLOCK("merge");
+        std::unordered_set<uint64_t> seen;
+        for(int i = 0; i < particles.size();) {
+            if(particles.temporary[i]) {
+                uint64_t cell = (uint32_t)((int)particles.x[i] + (int)particles.y[i] * width);
+                if(!seen.insert(cell << 32 | particles.tile[i].mat.id).second) {
+                    particles.remove(i);
+                    particleStats.merged++;
+                    continue;
+                }
+            }
+            i++;
+        }
+        EASY_END_BLOCK; // merge
+    }
 
     //std::for_each(particles.begin(), particles.end(), [](Particle* cur) {
     //	cur->vx += cur->ax;
@@ -2678,9 +2442,110 @@ void World::tickObjects() {
 
 }
 
-void World::addParticle(Particle* particle) {
+int World::addParticle(const Particle& particle) {
     EASY_FUNCTION(WORLD_PROFILER_COLOR);
-    particles.push_back(particle);
+    int budget = Settings::particle_budget;
+    int n = particles.size();
+
+    if(n >= budget) {
+        int lx = (int)particle.x;
+        int ly = (int)particle.y;
+        if(particle.temporary || particle.x < 0 || particle.y < 0 || lx >= width || ly >= height) {
+            particleStats.dropped++;
+        } else {
+            pendingDeposits.push_back({particle.tile, lx, ly, particle.x, particle.y});
+            particleStats.deposited++;
+        }
+        return -1;
+    }
+
+    int slot = particles.add(particle);
+    // the fuller the second half of the budget gets, the sooner new temporary particles die
+    if(particle.temporary && n > budget / 2) {
+        particles.lifetime[slot] = (int)((long long)particle.lifetime * (budget - n) / (budget - budget / 2));
+    }
+    return slot;
+}
+
+void World::updateSpatialGrid() {
+    EASY_FUNCTION(WORLD_PROFILER_COLOR);
+    binParticles();
+    binRigidBodies();
+}
+
+void World::binParticles() {
+    particleGrid.clear();
+    for(int i = 0; i < particles.size(); i++) {
+        particleGrid.add(i, (int)particles.x[i], (int)particles.y[i], (int)particles.x[i], (int)particles.y[i]);
+    }
+    particleGrid.build();
+    particleGridSize = particles.size();
+    particleGridX = lastLoadZone.x;
+    particleGridY = lastLoadZone.y;
+}
+
+void World::binRigidBodies() {
+    rigidBodyGrid.clear();
+    for(int i = 0; i < rigidBodies.size(); i++) {
+        RigidBody* cur = rigidBodies[i];
+        int w = cur->surface ? cur->surface->w : cur->matWidth;
+        int h = cur->surface ? cur->surface->h : cur->matHeight;
+        float s = sin(cur->body->GetAngle());
+        float c = cos(cur->body->GetAngle());
+        float px = cur->body->GetPosition().x;
+        float py = cur->body->GetPosition().y;
+
+        // bounds of the rotated surface, with some room for the truncation in the tools' inverse rotation
+        float minX = px, maxX = px, minY = py, maxY = py;
+        for(int corner = 1; corner < 4; corner++) {
+            float u = (corner & 1) ? (float)w : 0;
+            float v = (corner & 2) ? (float)h : 0;
+            float x = px + u * c - v * s;
+            float y = py + u * s + v * c;
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+        }
+        rigidBodyGrid.add(i, (int)floor(minX) - 2, (int)floor(minY) - 2, (int)ceil(maxX) + 2, (int)ceil(maxY) + 2);
+    }
+    rigidBodyGrid.build();
+    rigidBodyGridBodies = rigidBodies;
+    rigidBodyGridX = lastLoadZone.x;
+    rigidBodyGridY = lastLoadZone.y;
+}
+
+void World::particlesNear(int minX, int minY, int maxX, int maxY, std::vector<int>& out) {
+    // removing particles moves them between slots
+    if(particles.size() < particleGridSize) binParticles();
+
+    // everything moves when tickChunks catches up with the load zone
+    int dx = lastLoadZone.x - particleGridX;
+    int dy = lastLoadZone.y - particleGridY;
+    particleGrid.query(minX - dx, minY - dy, maxX - dx, maxY - dy, [&](int i) {
+        out.push_back(i);
+    });
+
+    // spawned since the grid was built
+    for(int i = particleGridSize; i < particles.size(); i++) out.push_back(i);
+}
+
+std::vector<RigidBody*> World::rigidBodiesNear(int minX, int minY, int maxX, int maxY) {
+    // bodies come and go between ticks: picked up, split, broken off
+    if(rigidBodies != rigidBodyGridBodies) binRigidBodies();
+
+    int dx = lastLoadZone.x - rigidBodyGridX;
+    int dy = lastLoadZone.y - rigidBodyGridY;
+    std::vector<int> found;
+    rigidBodyGrid.query(minX - dx, minY - dy, maxX - dx, maxY - dy, [&](int i) {
+        found.push_back(i);
+    });
+    std::sort(found.begin(), found.end());
+    found.erase(std::unique(found.begin(), found.end()), found.end());
+
+    std::vector<RigidBody*> rbs;
+    for(int i : found) rbs.push_back(rigidBodies[i]);
+    return rbs;
 }
 
 void World::explosion(int cx, int cy, int radius) {
@@ -2709,11 +2574,11 @@ void World::explosion(int cx, int cy, int radius) {
 
                     tile.color = rgb;
 
-                    particles.push_back(new Particle(tile, x, y + 1, dx / 10.0f + (rand() % 10 - 5) / 10.0f, dy / 6.0f + (rand() % 10 - 5) / 10.0f, 0, 0.1f));
+                    addParticle(Particle(tile, x, y + 1, dx / 10.0f + (rand() % 10 - 5) / 10.0f, dy / 6.0f + (rand() % 10 - 5) / 10.0f, 0, 0.1f));
                     setTile(x, y, Tiles::NOTHING);
                 }
             } else if(dx*dx + dy * dy < outerRadius * outerRadius && tile.mat->physicsType != PhysicsType::SOLID) {
-                particles.push_back(new Particle(tile, x, y, dx / 10.0f + (rand() % 10 - 5) / 10.0f, dy / 6.0f + (rand() % 10 - 5) / 10.0f, 0, 0.1f));
+                addParticle(Particle(tile, x, y, dx / 10.0f + (rand() % 10 - 5) / 10.0f, dy / 6.0f + (rand() % 10 - 5) / 10.0f, 0, 0.1f));
                 setTile(x, y, Tiles::NOTHING);
             }
         }
@@ -2731,38 +2596,56 @@ void World::frame() {
         //std::future<ChunkReadyToMerge> fut = ;
         //fut.wait();
         //readyToMerge.push_back(fut.get());
-        //std::vector<std::future<ChunkReadyToMerge>> readyToReadyToMerge;
-        readyToReadyToMerge.push_back(std::async(&World::loadChunk, this, getChunk(para.x, para.y), para.populate, true));
+        if(!chunkLoader->isLoading(para.x, para.y)) chunkLoader->queue(getChunk(para.x, para.y), para.populate, true);
 
         //std::thread t(&World::loadChunk, this, para.x, para.y, para.populate);
         //t.join();
         toLoad.erase(toLoad.begin());
     }
 
-    for(int i = 0; i < readyToReadyToMerge.size(); i++) {
-        if(readyToReadyToMerge[i]._Is_ready()) {
-            Chunk* merge = readyToReadyToMerge[i].get();
-
-            for(int i = 0; i < readyToMerge.size(); i++) {
-                if(readyToMerge[i] == merge) {
-                    readyToMerge.erase(readyToMerge.begin() + i);
-                    i--;
-                }
+    EASY_BLOCK("take loaded chunks");
+    std::vector<Chunk*> loaded;
+    std::vector<ChunkLoader::Failed> failed;
+    chunkLoader->takeLoaded(loaded, failed);
+    for(Chunk* merge : loaded) {
+        for(int i = 0; i < readyToMerge.size(); i++) {
+            if(readyToMerge[i] == merge) {
+                readyToMerge.erase(readyToMerge.begin() + i);
+                i--;
             }
+        }
 
-            readyToMerge.push_back(merge);
-            if(!chunkCache.count(merge->x)) {
-                auto h = google::dense_hash_map<int, Chunk*>();
-                h.set_deleted_key(INT_MAX);
-                h.set_empty_key(INT_MIN);
-                chunkCache[merge->x] = h;
-            }
-            chunkCache[merge->x][merge->y] = merge;
-            needToTickGeneration = true;
-            readyToReadyToMerge.erase(readyToReadyToMerge.begin() + i);
-            i--;
+        readyToMerge.push_back(merge);
+        if(!chunkCache.count(merge->x)) {
+            auto h = google::dense_hash_map<int, Chunk*>();
+            h.set_deleted_key(INT_MAX);
+            h.set_empty_key(INT_MIN);
+            chunkCache[merge->x] = h;
+        }
+        chunkCache[merge->x][merge->y] = merge;
+        needToTickGeneration = true;
+    }
+    // the worker already logged why, throw away what it left and try again with a fresh chunk
+    for(auto& f : failed) {
+        int cx = f.chunk->x;
+        int cy = f.chunk->y;
+        delete[] f.chunk->tiles;
+        delete[] f.chunk->layer2;
+        delete[] f.chunk->background;
+        delete[] f.chunk->biomes;
+        delete f.chunk;
+
+        if(f.attempts >= CHUNK_LOAD_ATTEMPTS) {
+            logError("Giving up on loading chunk {} {} after {} attempts", cx, cy, f.attempts);
+            continue;
         }
+        // it may have left the loaded area since it was queued
+        int tx = cx * CHUNK_W + loadZone.x;
+        int ty = cy * CHUNK_H + loadZone.y;
+        if(tx + CHUNK_W <= 0 || tx >= width || ty + CHUNK_H <= 0 || ty >= height) continue;
+        queueLoadChunk(cx, cy, f.populate, f.render);
     }
+    EASY_END_BLOCK;
     /*if (readyToReadyToMerge.size() > 0) {
         if (readyToReadyToMerge[0]._Is_ready()) {
             ChunkReadyToMerge merge = readyToReadyToMerge[0].get();
@@ -2793,6 +2676,11 @@ void World::frame() {
             }
         }
 
+        int mx = merge->x * CHUNK_W + loadZone.x;
+        int my = merge->y * CHUNK_H + loadZone.y;
+        wakeArea(mx - 1, my - 1, mx + CHUNK_W, my + CHUNK_H);
+        heatArea(mx - 1, my - 1, mx + CHUNK_W, my + CHUNK_H);
+
         //delete prop;
     }
 }
@@ -2953,9 +2841,13 @@ void World::tickChunks() {
                 }
             }
 
+            shiftSimTiles(changeX, changeY);
+            // the tiles moved under the bits, sleeping areas included
+            refreshLiveCells(0, 0, width - 1, height - 1);
+
             for(int i = 0; i < particles.size(); i++) {
-                particles[i]->x += changeX;
-                particles[i]->y += changeY;
+                particles.x[i] += changeX;
+                particles.y[i] += changeY;
             }
 
             for(int i = 0; i < rigidBodies.size(); i++) {
@@ -2972,8 +2864,10 @@ void World::tickChunks() {
 void World::queueLoadChunk(int cx, int cy, bool populate, bool render) {
     EASY_FUNCTION(WORLD_PROFILER_COLOR);
     //toLoad.push_back(LoadChunkParams(cx, cy, populate, 0));
-    Chunk* ch = getChunk(cx, cy);
-    if(ch->hasTileCache) {
+    Chunk* ch = chunkLoader->isLoading(cx, cy) ? nullptr : getChunk(cx, cy);
+    if(ch == nullptr) {
+        // already on a worker, frame adds it to chunkCache when it's done
+    } else if(ch->hasTileCache) {
         EASY_BLOCK("has tile cache");
         if(render) {
             EASY_BLOCK("remove from readyToMerge");
@@ -2995,40 +2889,10 @@ void World::queueLoadChunk(int cx, int cy, bool populate, bool render) {
         needToTickGeneration = true;
         EASY_END_BLOCK;
     } else {
-        EASY_BLOCK("preload");
-        for(int x = -1; x <= 1; x++) {
-            for(int y = 0; y <= 0; y++) {
-                Chunk* chb = getChunk(cx + x, y); // load chunk at ~x y
-                if(chb->pleaseDelete) {
-                    if(!chunkCache.count(chb->x)) {
-                        auto h = google::dense_hash_map<int, Chunk*>();
-                        h.set_deleted_key(INT_MAX);
-                        h.set_empty_key(INT_MIN);
-                        chunkCache[chb->x] = h;
-                    }
-                    auto a = &chunkCache[chb->x];
-                    chunkCache[chb->x][chb->y] = chb;
-                    chb->pleaseDelete = false;
-                    chb->generationPhase = -1;
-                }
-            }
-        }
-        EASY_END_BLOCK;
-
-        loadChunk(ch, populate, render);
-
-        EASY_BLOCK("postload");
-        readyToMerge.push_back(ch);
-        if(!chunkCache.count(ch->x)) {
-            chunkCache[ch->x] = google::dense_hash_map<int, Chunk*>();
-            chunkCache[ch->x].set_deleted_key(INT_MAX);
-            chunkCache[ch->x].set_empty_key(INT_MIN);
-        }
-        chunkCache[ch->x][ch->y] = ch;
-        needToTickGeneration = true;
-        EASY_END_BLOCK;
+        // page the saved chunk in while it waits for its loader
+        if(ch->region) ch->region->prefetch(RegionFile::local(ch->x), RegionFile::local(ch->y));
 
-        //readyToReadyToMerge.push_back(std::async(&World::loadChunk, this, ch, populate, render));
+        chunkLoader->queue(ch, populate, render);
     }
 
     EASY_BLOCK("fill temp tiles");
@@ -3049,22 +2913,25 @@ void World::queueLoadChunk(int cx, int cy, bool populate, bool render) {
     //loadChunk(cx, cy, populate);
 }
 
-Chunk* World::loadChunk(Chunk* ch, bool populate, bool render) {
+Chunk* World::loadChunk(Chunk* ch, bool populate, bool render, std::vector<char>& scratch) {
     EASY_FUNCTION(WORLD_PROFILER_COLOR);
 
     long long st = Time::millis();
 
     ch->pleaseDelete = false;
 
-    if(ch->hasTileCache) {
-        //prop = ch->tiles;
-    } else if(ch->hasFile()) {
-        ch->read();
-    } else {
+    // reading tells a missing chunk apart by itself, checking hasFile first could race with the ChunkWriter removing the old file
+    if(!ch->hasTileCache && !ch->read(scratch)) {
+        EASY_BLOCK("generate");
         generateChunk(ch);
         ch->generationPhase = 0;
         ch->hasTileCache = true;
+        EASY_END_BLOCK;
+
+        EASY_BLOCK("populate phase 0");
         populateChunk(ch, 0, false);
+        EASY_END_BLOCK;
+
         ch->write(ch->tiles, ch->layer2, ch->background);
     }
 
@@ -3211,7 +3078,7 @@ void World::addStructure(PlacedStructure str) {
             //if(ch.e)
             if(dx >= 0 && dy >= 0 && dx < width && dy < height) {
                 tiles[dx + dy * width] = str.base.tiles[x + y * str.base.w];
-                dirty[dx + dy * width] = true;
+                markDirty(dx + dy * width);
             }
         }
     }
@@ -3265,6 +3132,9 @@ Chunk* World::getChunk(int cx, int cy) {
         if (chunkCache[i]->x == cx && chunkCache[i]->y == cy) return chunkCache[i];
     }*/
     Chunk* c = new Chunk(cx, cy, worldName);
+    c->region = getRegion(cx, cy);
+    c->hasOwnFile = ownFileChunks.count((uint64_t)(uint32_t)cx << 32 | (uint32_t)cy) != 0;
+    c->writer = chunkWriter;
     c->generationPhase = -1;
     c->pleaseDelete = true;
     c->biomes = new Biome*[CHUNK_W * CHUNK_H];
@@ -3272,6 +3142,22 @@ Chunk* World::getChunk(int cx, int cy) {
     return c;
 }
 
+RegionFile* World::getRegion(int cx, int cy) {
+    int rx = RegionFile::region(cx);
+    int ry = RegionFile::region(cy);
+    uint64_t key = (uint64_t)(uint32_t)rx << 32 | (uint32_t)ry;
+
+    std::lock_guard<std::mutex> lock(regionsMtx);
+    auto it = regions.find(key);
+    if(it != regions.end()) return it->second;
+
+    char buff[255];
+    snprintf(buff, sizeof(buff), "%s/regions/region_%d_%d.dat", worldName, rx, ry);
+    RegionFile* r = new RegionFile(buff);
+    regions[key] = r;
+    return r;
+}
+
 void World::populateChunk(Chunk* ch, int phase, bool render) {
     bool has = hasPopulator[phase];
     if(!hasPopulator[phase]) return;
@@ -3292,7 +3178,8 @@ void World::populateChunk(Chunk* ch, int phase, bool render) {
 
     for(int cx = ax; cx < ax + aw; cx++) {
         for(int cy = ay; cy < ay + ah; cy++) {
-            chs[(cx - ax) + (cy - ay) * aw] = *getChunk(cx, cy);
+            // ch may not be in chunkCache yet when it's populated by a ChunkLoader worker
+            chs[(cx - ax) + (cy - ay) * aw] = (cx == ch->x && cy == ch->y) ? *ch : *getChunk(cx, cy);
             dirtyChunk[(cx - ax) + (cy - ay) * aw] = false;
         }
     }
@@ -3409,9 +3296,9 @@ void World::tickEntities(GPU_Target* t) {
                                 } else {
                                     MaterialInstance tp = tiles[sx + sy * width];
                                     if(tp.mat->physicsType == PhysicsType::SAND) {
-                                        addParticle(new Particle(tp, sx, sy, (rand() % 10 - 5) / 10.0f + 0.5f, (rand() % 10 - 5) / 10.0f, 0, 0.1f));
+                                        addParticle(Particle(tp, sx, sy, (rand() % 10 - 5) / 10.0f + 0.5f, (rand() % 10 - 5) / 10.0f, 0, 0.1f));
                                         tiles[sx + sy * width] = Tiles::NOTHING;
-                                        dirty[sx + sy * width] = true;
+                                        markDirty(sx + sy * width);
 
                                         cur->vx *= 0.99;
                                     } else {
@@ -3463,9 +3350,9 @@ void World::tickEntities(GPU_Target* t) {
                                 } else {
                                     MaterialInstance tp = tiles[sx + sy * width];
                                     if(tp.mat->physicsType == PhysicsType::SAND) {
-                                        addParticle(new Particle(tp, sx, sy, (rand() % 10 - 5) / 10.0f - 0.5f, (rand() % 10 - 5) / 10.0f, 0, 0.1f));
+                                        addParticle(Particle(tp, sx, sy, (rand() % 10 - 5) / 10.0f - 0.5f, (rand() % 10 - 5) / 10.0f, 0, 0.1f));
                                         tiles[sx + sy * width] = Tiles::NOTHING;
-                                        dirty[sx + sy * width] = true;
+                                        markDirty(sx + sy * width);
 
                                         cur->vx *= 0.99;
                                     } else {
@@ -3533,9 +3420,9 @@ void World::tickEntities(GPU_Target* t) {
                             if(tiles[sx + sy * width].mat->physicsType == PhysicsType::SOLID || tiles[sx + sy * width].mat->physicsType == PhysicsType::SAND || tiles[sx + sy * width].mat->physicsType == PhysicsType::OBJECT) {
                                 MaterialInstance tp = tiles[sx + sy * width];
                                 if(tp.mat->physicsType == PhysicsType::SAND) {
-                                    addParticle(new Particle(tp, sx, sy, (rand() % 10 - 5) / 10.0f, (rand() % 10 - 5) / 10.0f - 0.5f, 0, 0.1f));
+                                    addParticle(Particle(tp, sx, sy, (rand() % 10 - 5) / 10.0f, (rand() % 10 - 5) / 10.0f - 0.5f, 0, 0.1f));
                                     tiles[sx + sy * width] = Tiles::NOTHING;
-                                    dirty[sx + sy * width] = true;
+                                    markDirty(sx + sy * width);
 
                                     cur->vy *= 0.99;
                                 } else {
@@ -3576,19 +3463,23 @@ World::~World() {
     delete layer2;
     delete background;
 
-    for(auto& v : particles) {
-        delete v;
-    }
     particles.clear();
 
-    tickPool->stop(false);
-    delete tickPool;
+    delete tickScheduler;
 
     delete newTemps;
+    delete[] tempPlane;
+    delete[] conductionPlane;
+    delete[] conductionSelfPlane;
+    delete[] addTempPlane;
+    delete[] reactBelowPlane;
+    delete[] reactAbovePlane;
 
     delete dirty;
-    delete active;
-    delete lastActive;
+    delete[] simTiles;
+    delete[] liveCells;
+    delete[] tickVisited;
+    delete[] depositAir;
     delete layer2Dirty;
     delete backgroundDirty;
 
@@ -3610,7 +3501,17 @@ World::~World() {
 
     toLoad.clear();
 
-    readyToReadyToMerge.clear();
+    // what the workers finish is deleted with readyToMerge
+    if(chunkLoader) {
+        chunkLoader->finish();
+        std::vector<Chunk*> loaded;
+        std::vector<ChunkLoader::Failed> failed;
+        chunkLoader->takeLoaded(loaded, failed);
+        readyToMerge.insert(readyToMerge.end(), loaded.begin(), loaded.end());
+        // failed ones too, they're only deleted
+        for(auto& f : failed) readyToMerge.push_back(f.chunk);
+        delete chunkLoader;
+    }
 
     for(auto& v : readyToMerge) {
         delete v;
@@ -3632,6 +3533,14 @@ World::~World() {
     }
     chunkCache.clear();
 
+    // saves what's still waiting, the regions have to stay open until then
+    delete chunkWriter;
+
+    for(auto& v : regions) {
+        delete v.second;
+    }
+    regions.clear();
+
     for(auto& v : populators) {
         delete v;
     }
@@ -3785,7 +3694,7 @@ RigidBody* World::physicsCheck(int x, int y) {
                     if(visited[xx + yy * width]) {
                         PIXEL(tex, xx - minX, yy - minY) = cols[xx + yy * width];
                         tiles[xx + yy * width] = Tiles::NOTHING;
-                        dirty[xx + yy * width] = true;
+                        markDirty(xx + yy * width);
                     }
                 }
             }
@@ -3819,7 +3728,7 @@ RigidBody* World::physicsCheck(int x, int y) {
                 for (int xx = minX; xx <= maxX; xx++) {
                     if (visited[xx + yy * width]) {
                         tiles[xx + yy * width] = Tiles::NOTHING;
-                        dirty[xx + yy * width] = true;
+                        markDirty(xx + yy * width);
                     }
                 }
             }
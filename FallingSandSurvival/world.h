@@ -10,6 +10,7 @@
 #include "Networking.h"
 #include <vector>
 #include <deque>
+#include <climits>
 #include "Particle.h"
 #include <box2d/b2_math.h>
 #include <box2d/b2_world.h>
@@ -20,6 +21,7 @@
 #include "ChunkReadyToMerge.h"
 #include <future>
 #include <unordered_map>
+#include <unordered_set>
 #include "lib/FastNoiseSIMD/FastNoiseSIMD.h"
 #include "lib/FastNoise/FastNoise.h"
 #include "lib/sparsehash/dense_hash_map.h"
@@ -43,6 +45,12 @@
 
 #include "ProfilerConfig.h"
 
+#include "Random.h"
+#include "TaskScheduler.h"
+#include "SpatialGrid.h"
+#include "ChunkWriter.h"
+#include "ChunkLoader.h"
+
 class Populator;
 class WorldGenerator;
 class Player;
@@ -61,6 +69,74 @@ public:
     }
 };
 
+// World::tick only scans sim tiles that changed recently
+// CHUNK_W and CHUNK_H must be multiples of these
+#define SIM_TILE_W 32
+#define SIM_TILE_H 32
+// number of quiet ticks before a sim tile goes to sleep
+#define SIM_SLEEP_TICKS 10
+// rows per World::tickTemperature task, must be a multiple of SIM_TILE_H
+#define TEMPERATURE_BAND_H (SIM_TILE_H * 2)
+// particles per World::tickParticles task
+#define PARTICLE_BATCH 2048
+// how far from where it hit World::depositParticle looks for air
+#define DEPOSIT_RADIUS 10
+// side of the squares World::depositParticle remembers air for
+#define DEPOSIT_BLOCK 8
+
+// inclusive cell bounds in world coordinates, empty when minX > maxX
+class SimRect {
+public:
+    int minX = INT_MAX;
+    int minY = INT_MAX;
+    int maxX = INT_MIN;
+    int maxY = INT_MIN;
+
+    bool empty() {
+        return minX > maxX;
+    }
+
+    void clear() {
+        minX = minY = INT_MAX;
+        maxX = maxY = INT_MIN;
+    }
+
+    void add(int x0, int y0, int x1, int y1) {
+        if(x0 < minX) minX = x0;
+        if(y0 < minY) minY = y0;
+        if(x1 > maxX) maxX = x1;
+        if(y1 > maxY) maxY = y1;
+    }
+};
+
+class SimTile {
+public:
+    // cells World::tick scans
+    SimRect scan;
+    // cells woken since the last commit
+    SimRect wake;
+    int sleep = 0;
+    // cells World::tickTemperature diffuses this pass, and cells whose temperature may change by the next one
+    // everything outside of them already sits at its fixed point
+    SimRect heat;
+    SimRect heatWake;
+    // some cell of the tile held a non-zero temperature after the last pass,
+    // so anything moving around in it changes how the heat flows
+    bool warm = false;
+};
+
+// what one chunk task of World::tick carries from cell to cell
+class ChunkTickState {
+public:
+    int iter;
+    uint16_t visit;
+    Random rng;
+    // particles emitted by the task, one of World::tickEmitted
+    std::vector<Particle>& parts;
+
+    ChunkTickState(int iter, uint16_t visit, Random rng, std::vector<Particle>& parts) : iter(iter), visit(visit), rng(rng), parts(parts) {};
+};
+
 class WorldMeta {
 public:
     std::string worldName;
@@ -81,7 +157,7 @@ public:
     MaterialInstance* tiles = nullptr;
     MaterialInstance* layer2 = nullptr;
     Uint32* background = nullptr;
-    std::vector<Particle *> particles;
+    ParticleStore particles;
     uint16_t width = 0;
     uint16_t height = 0;
     void init(char* worldPath, uint16_t w, uint16_t h, GPU_Target* renderer, CAudioEngine* audioEngine, int netMode);
@@ -90,27 +166,126 @@ public:
     MaterialInstance getTileLayer2(int x, int y);
     void setTileLayer2(int x, int y, MaterialInstance type);
     int tickCt = 0;
-    ctpl::thread_pool* tickPool = nullptr;
+    // seeds the world noise and the per-chunk Random streams in tick()
+    uint32_t seed = 0;
+    TaskScheduler* tickScheduler = nullptr;
 
     GPU_Image* fireTex = nullptr;
-    bool* tickVisited = nullptr;
+    // per-cell mark of the last checkerboard phase that visited it, see tickVisitStamp
+    uint16_t* tickVisited = nullptr;
+    uint16_t tickVisitStamp = 0;
+    // particles emitted by each chunk task of the current tick, merged into particles at the end of it
+    std::vector<std::vector<Particle>> tickEmitted;
     void tick();
+    void tickCells();
+    void tickPhysicsCheck();
+    // the cellular automaton kernel, one chunk at a time
+    // pass 1 burns, interacts and falls, pass 2 slides diagonally, pass 3 spreads sideways
+    template<bool reverseX> void tickChunk(int cx, int cy, ChunkTickState& st);
+    template<int pass, bool reverseX> void tickChunkPass(int cx, int cy, ChunkTickState& st);
+    template<int pass, int type> void tickCell(int x, int y, int index, ChunkTickState& st);
+    bool tickInteractions(int x, int y, MaterialInstance tile, MaterialInstance belowTile, ChunkTickState& st);
+    void tickFall(int x, int y, MaterialInstance tile, MaterialInstance belowTile, int slideChance, ChunkTickState& st);
+    void tickSlide(int x, int y, MaterialInstance tile, int side, bool markMoved, ChunkTickState& st);
+    void tickSwap(int index, int other, ChunkTickState& st);
 
     void tickTemperature();
+    // copies cells of one row out of the tiles into the temperature planes
+    void gatherTemperatureRow(int y, int minX, int maxX);
+    // writes cells of one row of newTemps back into the tiles and wakes the heat around whatever changed
+    // cells past one of their reaction temperatures go on `reactions`, returns whether any of them is non-zero
+    bool commitTemperatureRow(int y, int minX, int maxX, std::vector<int>& reactions);
+    // turns the cell into whatever its temperature reactions make of it
+    void applyReactions(int index);
+    // whether any cell of the sim tile has a non-zero temperature
+    bool simTileWarm(int tx, int ty);
     int32_t* newTemps = nullptr;
+    // per cell temperature and material properties for Temperature::diffuseRow
+    int16_t* tempPlane = nullptr;
+    float* conductionPlane = nullptr;
+    float* conductionSelfPlane = nullptr;
+    int32_t* addTempPlane = nullptr;
+    int32_t* reactBelowPlane = nullptr;
+    int32_t* reactAbovePlane = nullptr;
     void frame();
     void tickParticles();
+    // moves particle i one tick, returns whether it died
+    // only reads the tiles, a particle that lands goes on `deposits` instead of being written back
+    bool tickParticle(int i, std::vector<ParticleDeposit>& deposits);
+    void depositParticle(const ParticleDeposit& d);
+    // whether a DEPOSIT_BLOCK square has any air, remembered until resetDepositAir
+    bool depositBlockHasAir(int bx, int by);
+    void resetDepositAir();
+    // 0 unknown, 1 some air, 2 no air
+    Uint8* depositAir = nullptr;
+    int depositAirW = 0;
+    std::vector<int> depositAirTouched;
+    // clears the pixels it drew last time and draws every particle
+    // [particleDirtyFirst, particleDirtyLast] spans the cells of both, both are -1 if there were none
     void renderParticles(unsigned char** texture);
+    std::vector<unsigned int> particlePixels;
+    int particleDirtyFirst = -1;
+    int particleDirtyLast = -1;
     void tickObjects();
     void tickObjectsMesh();
     void tickChunks();
     void tickChunkGeneration();
     bool needToTickGeneration = false;
-    void addParticle(Particle* particle);
+    // the region file of a chunk, opened on first use and kept open until the world is deleted
+    RegionFile* getRegion(int cx, int cy);
+    std::unordered_map<uint64_t, RegionFile*> regions;
+    std::mutex regionsMtx;
+    // chunks that still have a file of their own from before region files, found once by init
+    std::unordered_set<uint64_t> ownFileChunks;
+    // saves chunks in the background, flush it before quitting
+    ChunkWriter* chunkWriter = nullptr;
+    // returns the slot in particles, or -1 if the particle budget turned it into a deposit or dropped it
+    int addParticle(const Particle& particle);
+    // particles spawned past the budget, written into the tiles by the next tickParticles
+    std::vector<ParticleDeposit> pendingDeposits;
+    ParticleStats particleStats;
     void explosion(int x, int y, int radius);
+
+    // particles and rigid bodies binned by position so tools only look at what's near them
+    // rebuilt once per tick by updateSpatialGrid, the queries make up for what changed since
+    SpatialGrid particleGrid;
+    SpatialGrid rigidBodyGrid;
+    // what the grids were built from: the load zone at the time, the particle count and the bodies
+    int particleGridX = 0;
+    int particleGridY = 0;
+    int particleGridSize = 0;
+    int rigidBodyGridX = 0;
+    int rigidBodyGridY = 0;
+    std::vector<RigidBody*> rigidBodyGridBodies;
+    void updateSpatialGrid();
+    void binParticles();
+    void binRigidBodies();
+    // slots of the particles that may be inside the box, each one once
+    void particlesNear(int minX, int minY, int maxX, int maxY, std::vector<int>& out);
+    // rigid bodies whose bounds may overlap the box, in the order of rigidBodies
+    std::vector<RigidBody*> rigidBodiesNear(int minX, int minY, int maxX, int maxY);
     bool* dirty = nullptr;
-    bool* active = nullptr;
-    bool* lastActive = nullptr;
+    SimTile* simTiles = nullptr;
+    int simTilesW = 0;
+    int simTilesH = 0;
+    void markDirty(int index);
+    void wake(int x, int y);
+    void wakeArea(int minX, int minY, int maxX, int maxY);
+    void heatArea(int minX, int minY, int maxX, int maxY);
+    template<typename F> void forSimTiles(int minX, int minY, int maxX, int maxY, F fn);
+    void wakeDirty();
+    void commitSimTiles();
+    void commitSimTiles(int cx, int cy);
+    void sleepSimTiles();
+    void shiftSimTiles(int dx, int dy);
+    bool simChunkAwake(int cx, int cy);
+    bool simRowRange(int cx, int y, int* minX, int* maxX);
+    // one bit per cell holding a Materials::LIVE material, so the scan can jump over runs of air and solids
+    // markDirty and setTile keep it exact, anything else gets refreshed from tiles when its wake is committed
+    uint64_t* liveCells = nullptr;
+    int liveCellsStride = 0;
+    void updateLiveCell(int x, int y);
+    void refreshLiveCells(int minX, int minY, int maxX, int maxY);
     bool* popDirty();
     bool* layer2Dirty = nullptr;
     bool* popLayer2Dirty();
@@ -140,10 +315,12 @@ public:
     std::vector<RigidBody*> worldRigidBodies;
 
     std::vector<LoadChunkParams> toLoad;
-    std::vector<std::shared_future<Chunk*>> readyToReadyToMerge;
+    // chunks being read or generated, frame moves them to readyToMerge when they're done
+    ChunkLoader* chunkLoader = nullptr;
     std::deque<Chunk*> readyToMerge;
     void queueLoadChunk(int cx, int cy, bool populate, bool render);
-    Chunk* loadChunk(Chunk*, bool populate, bool render);
+    // runs on the ChunkLoader workers, scratch is the worker's decode buffer
+    Chunk* loadChunk(Chunk*, bool populate, bool render, std::vector<char>& scratch);
     void unloadChunk(Chunk* ch);
     WorldGenerator* gen = nullptr;
     void generateChunk(Chunk* ch);